@@ -1,35 +1,49 @@
+#include "config.h"
+
+#if FEATURE_AUDIO
+
 #include "MKL25Z4.h"  // Device header
+#include "cmsis_os2.h"
 #include "audio.h"
-
-#define PTB0_Pin 0
-#define PTB1_Pin 1
+#include "deadline.h"
+#include "timebase.h"
+#include "melody.h"
+#include "fixmath.h"
+#include "wavetrace.h"
+#include "musclock.h"
+#include "coop.h"
+#include "envelope.h"
+#include "params.h"
+
+// Deadline monitor handle: one job per note, period = note duration.
+static int audio_deadline = -1;
+
+volatile uint16_t audio_note_hz = 0;
+
+static inline void set_note_hz(uint16_t hz) {
+  audio_note_hz = hz;
+  WAVE_SET(WAVE_BUZZER_HZ, hz);
+}
 
 void initPWM(int frequency) 
 {
-  // Enable clock gating for PORTB.
-  SIM_SCGC5 |= SIM_SCGC5_PORTB_MASK;
-  
-  // Configure Mode 3 for PWM pin configuration.
-  PORTB->PCR[PTB0_Pin] &= ~PORT_PCR_MUX_MASK;
-  PORTB->PCR[PTB0_Pin] |= PORT_PCR_MUX(3);
-  
-  PORTB->PCR[PTB1_Pin] &= ~PORT_PCR_MUX_MASK;
-  PORTB->PCR[PTB1_Pin] |= PORT_PCR_MUX(3);
+  // PTB0/PTB1 are muxed to TPM1 (ALT3) once by board_init(), not per note.
   
   // Enable clock gating for Timer 1.
   SIM->SCGC6 |= SIM_SCGC6_TPM1_MASK;
   
-  // Select clock source.
-  SIM->SOPT2 &= ~SIM_SOPT2_TPMSRC_MASK;
-  SIM->SOPT2 |= SIM_SOPT2_TPMSRC(1);
+  // Clock source (TPMSRC = OSCERCLK) is set once by timebase_init(). It is
+  // shared by TPM0-2, so it must not be touched per note.
   
   // Set MOD register for PWM frequency calculation (integer ceiling).
-  TPM1->MOD = (48000000 / 128 + frequency - 1) / frequency;
+  // 8 MHz / 8 = 1 MHz counter clock. Reciprocal divide: no divide instruction.
+  TPM1->MOD = fix_udiv16(TIMEBASE_TPM_CLOCK_HZ + frequency - 1, (uint16_t)frequency);
   TPM1_C0V = (TPM1->MOD + 1) / 2; // 50% duty cycle
+  set_note_hz((uint16_t)frequency);
   
   // Set edge-aligned PWM mode.
   TPM1->SC &= ~((TPM_SC_CMOD_MASK) | (TPM_SC_PS_MASK));
-  TPM1->SC |= (TPM_SC_CMOD(1) | TPM_SC_PS(7));
+  TPM1->SC |= (TPM_SC_CMOD(1) | TPM_SC_PS(3));
   TPM1->SC &= ~(TPM_SC_CPWMS_MASK);
   
    TPM1_C0SC &= ~((TPM_CnSC_ELSB_MASK) | (TPM_CnSC_ELSA_MASK) |
@@ -38,182 +52,169 @@ void initPWM(int frequency)
    TPM1_C0SC |= (TPM_CnSC_MSB(1) | TPM_CnSC_ELSB(1)); 
  }
 
-void delay_ms(uint32_t ms) {
-    // Simple blocking delay loop (not power efficient).
-    for (volatile uint32_t i = 0; i < (ms * 4000); i++);
+static void buzzer_off(void) {
+    TPM1->SC &= ~TPM_SC_CMOD_MASK; // Disable TPM1 counter
+    envelope_off();
+    set_note_hz(0);
+}
+
+// --- Playback Parameters ---
+// Applied to every note as it starts, so one stored melody plays at any
+// tempo and pitch. Both are in twelfth-octave steps (fix_scale_semitones):
+// +12 tempo halves every duration, +12 transpose doubles every frequency.
+static volatile int8_t tempo_steps = 0;
+static volatile int8_t transpose_steps = 0;
+
+void audio_set_playback(int8_t tempo, int8_t transpose) {
+    tempo_steps = (tempo > AUDIO_STEPS_MAX) ? AUDIO_STEPS_MAX : (tempo < -AUDIO_STEPS_MAX) ? -AUDIO_STEPS_MAX : tempo;
+    transpose_steps = (transpose > AUDIO_STEPS_MAX) ? AUDIO_STEPS_MAX
+                    : (transpose < -AUDIO_STEPS_MAX) ? -AUDIO_STEPS_MAX : transpose;
 }
 
-// Melody 1: Mary Had a Little Lamb
-// Note frequencies (Hz): C=262, D=294, E=330, G=392
-void playtune_melody1(void) {
-    int melody[] = {
-        330, 294, 262, 294, 330, 330, 330,
-        294, 294, 294,
-        330, 392, 392,
-        330, 294, 262, 294, 330, 330, 330
-    };
-    int numNotes = sizeof(melody) / sizeof(melody[0]);
-    int noteDuration = 500; // 500ms per note
-    
-    for (int i = 0; i < numNotes; i++) {
-        initPWM(melody[i]);
-        delay_ms(noteDuration);
-    }
-    // Stop PWM after the melody finishes
-    TPM1->SC &= ~TPM_SC_CMOD_MASK; // Disable TPM1 counter
+int8_t audio_tempo(void) {
+    return tempo_steps;
 }
 
-// Melody 2: Twinkle Twinkle Little Star (example melody)
-void playtune_melody2(void) {
-    int melody[] = {
-        262, 262, 392, 392, 440, 440, 392, 
-        349, 349, 330, 330, 294, 294, 262
-    };
-    int numNotes = sizeof(melody) / sizeof(melody[0]);
-    int noteDuration = 500; // 500ms per note
-
-    for (int i = 0; i < numNotes; i++) {
-        initPWM(melody[i]);
-        delay_ms(noteDuration);
+int8_t audio_transpose(void) {
+    return transpose_steps;
+}
+
+static uint32_t play_ms(uint32_t ms) {
+    return (tempo_steps == 0) ? ms : fix_scale_semitones(ms, -tempo_steps);
+}
+
+static uint16_t play_hz(uint16_t hz) {
+    if (hz == 0 || transpose_steps == 0) {
+        return hz;
     }
-    TPM1->SC &= ~TPM_SC_CMOD_MASK; // Disable TPM1 counter
+    uint32_t scaled = fix_scale_semitones(hz, transpose_steps);
+    // TPM1 MOD is 16 bits at 1 MHz: 16 Hz is the lowest note it can hold.
+    return (uint16_t)((scaled < 16U) ? 16U : (scaled > 20000U) ? 20000U : scaled);
 }
 
+// One deadline job per note: period = note duration. The note gets an
+// attack/decay/release envelope (envelope.h) instead of a flat 50% duty.
+// Returns the duration after tempo scaling.
+static uint32_t note_start(uint16_t hz, uint32_t duration_ms) {
+    hz = play_hz(hz);
+    duration_ms = play_ms(duration_ms);
+    deadline_set_period(audio_deadline, duration_ms);
+    deadline_release(audio_deadline);
+    if (hz != 0) {
+        initPWM(hz);
+        envelope_note(duration_ms);
+    } else {
+        buzzer_off(); // Rest
+    }
+    musclock_note(timebase_now_us(), duration_ms);
+    deadline_complete(audio_deadline);
+    return duration_ms;
+}
 
-// --- Audio Thread Function ---
-// Original:
-// void audio_thread(void *argument) {
-//     playtune_melody1();
-//     // Thread will terminate after playing the melody once in this test setup.
-// }
+// Melody 1: Mary Had a Little Lamb
+// Note frequencies (Hz): C=262, D=294, E=330, G=392
+static const uint16_t melody1[] = {
+    330, 294, 262, 294, 330, 330, 330,
+    294, 294, 294,
+    330, 392, 392,
+    330, 294, 262, 294, 330, 330, 330
+};
 
-// Modified:
-void audio_thread(void *argument) {
+// Melody 2: Twinkle Twinkle Little Star (example melody)
+static const uint16_t melody2[] = {
+    262, 262, 392, 392, 440, 440, 392,
+    349, 349, 330, 330, 294, 294, 262
+};
+
+// Built-in melodies by PARAM_MELODY_RUN/PARAM_MELODY_DONE value.
+static const struct {
+    const uint16_t *notes;
+    uint32_t        count;
+} builtin[] = {
+    { melody1, sizeof(melody1) / sizeof(melody1[0]) },
+    { melody2, sizeof(melody2) / sizeof(melody2[0]) }
+};
+
+// --- Audio Task ---
+// The former audio thread as a coop task: an uploaded melody wins over the
+// built-in ones, with a pause between plays that a streamed melody cuts
+// short. Each note is started here and the task then yields until the note's
+// absolute end time, so delays do not accumulate.
+
+#define AUDIO_PAUSE_MS    1000
+#define AUDIO_DEADLINE_US 1000  // Note onsets come before LED frames
+
+// Kept across yields.
+static struct {
+    const uint16_t *melody;
+    uint32_t        count;
+    uint32_t        index;
+    uint32_t        note_ms;
+    uint32_t        note_end;
+    MelodyNote      note;
+} play;
+
+static int8_t audio_task_run(CoopTask *task) {
+    COOP_BEGIN(task);
+    melody_set_player(osThreadGetId()); // MELODY_FLAG_DATA arrives as a coop signal
     for (;;) {
-        if (runComplete) {
-            playtune_melody2();
+        if (melody_pending()) {
+            // Streamed melody: notes from the melody ring until MELODY_END, or
+            // until nothing has arrived for MELODY_STALL_MS (melody.h).
+            musclock_start(play_ms(MUSCLOCK_STREAM_BEAT_MS));
+            play.note_end = timebase_now_us();
+            deadline_resync(audio_deadline);
+            for (;;) {
+                if (!melody_next(&play.note)) {
+                    // Underrun: go silent rather than hold the last note, then start
+                    // timing again from whenever the next note turns up.
+                    buzzer_off();
+                    melody_stats.underruns++;
+                    do { // The signal may be left over from a frame already played
+                        COOP_WAIT_SIGNAL(task, MELODY_FLAG_DATA, MELODY_STALL_MS * 1000U);
+                    } while (task->signals != 0 && !melody_pending());
+                    if (task->signals == 0) {
+                        melody_stats.stalls++;
+                        break;
+                    }
+                    play.note_end = timebase_now_us();
+                    deadline_resync(audio_deadline);
+                    continue;
+                }
+                if (play.note.note == MELODY_END) {
+                    break;
+                }
+                uint32_t duration_ms = play.note.units * MELODY_UNIT_MS;
+                play.note_end += note_start(melody_note_hz(play.note.note), duration_ms) * 1000U;
+                melody_stats.notes_played++;
+                COOP_SLEEP_UNTIL(task, play.note_end);
+            }
         } else {
-            playtune_melody1();
+            play.index = (uint32_t)params_get(runComplete ? PARAM_MELODY_DONE : PARAM_MELODY_RUN);
+            play.melody = builtin[play.index].notes;
+            play.count = builtin[play.index].count;
+            play.note_ms = (uint32_t)params_get(PARAM_NOTE_MS);
+            musclock_start(play_ms(play.note_ms)); // One note per beat
+            play.note_end = timebase_now_us();
+            deadline_resync(audio_deadline);
+            for (play.index = 0; play.index < play.count; play.index++) {
+                play.note_end += note_start(play.melody[play.index], play.note_ms) * 1000U;
+                COOP_SLEEP_UNTIL(task, play.note_end);
+            }
         }
-        osDelay(1000); // Optional delay between plays
+        buzzer_off();
+        musclock_stop();
+        // Pause between plays, cut short when a streamed melody arrives.
+        COOP_WAIT_SIGNAL(task, MELODY_FLAG_DATA, AUDIO_PAUSE_MS * 1000U);
     }
+    COOP_END(task);
 }
 
+static CoopTask audio_task = COOP_TASK("audio", audio_task_run, AUDIO_DEADLINE_US);
 
-
-//void audio_thread(void *argument) {
-//    // Initialize PWM once before starting the loop (optional, could be done in main)
-//    // initPWM(1000); // Initialize with a default frequency or handle inside playtune
-
-//	playtune_melody1();
-//    // --- Play Super Mario theme ---
-////    playtune_supermario(); // Play Super Mario theme once
-
-//    // --- Original loop (commented out) ---
-//    /*
-//    for (;;) {
-//        // Example: Play Super Mario theme repeatedly with a delay
-//        playtune_supermario();
-//        osDelay(5000); // Wait 5 seconds before playing again
-//        // Add logic here to decide when/what to play based on robot state or events
-//    }
-//    */
-//   // Thread will terminate after playing the melody once in this test setup.
-//   // For continuous operation based on state, the loop below should be used.
-//}
-
-
-// Melody 3: Super Mario Bros Theme (simplified excerpt)
-// Note frequencies (Hz):
-// E7 ~2640, C7 ~2096, G7 ~3136, G6 ~1568
-// A zero value indicates a rest (pause).
-void playtune_supermario(void) {
-    int melody[] = {
-        // Main theme intro
-        2640, 0, 2640, 0, 0, 2640, 0, 0, 2096, 0, 2640, 0, 0, 3136, 0, 0, 0, 0,
-        
-        // Main theme part 1
-        1568, 0, 0, 0, 1046, 0, 0, 1568, 0, 0, 2093, 0, 0, 1760, 0, 1568, 0, 0, 1319, 0, 
-        1046, 0, 0, 0, 1319, 0, 0, 1760, 0, 0, 2093, 0, 0, 3136, 0, 0, 3520, 0, 0, 2793, 0, 2637, 0, 0,
-        
-        // Main theme part 2
-        2093, 0, 0, 0, 2793, 0, 2637, 0, 0, 2093, 0, 0, 0, 1760, 0, 0, 1976, 0, 0, 1865, 0, 
-        1760, 0, 0, 0, 1568, 0, 2093, 0, 0, 2640, 0, 0, 3136, 0, 0, 3520, 0, 0,
-        
-        // Underground theme
-        1319, 0, 1568, 0, 2093, 0, 1319, 0, 1568, 0, 2093, 0, 0, 0,
-        1319, 0, 1568, 0, 2093, 0, 1319, 0, 1568, 0, 2093, 0, 0, 0,
-        1175, 0, 1397, 0, 1865, 0, 1175, 0, 1397, 0, 1865, 0, 0, 0,
-        1175, 0, 1397, 0, 1865, 0, 1175, 0, 1397, 0, 1865, 0, 0, 0,
-        
-        // Starman invincibility theme
-        2093, 0, 2093, 0, 2093, 0, 1568, 0, 2093, 0, 2637, 0, 0, 0,
-        2093, 0, 2093, 0, 2093, 0, 1568, 0, 2093, 0, 0, 0,
-        2349, 0, 2349, 0, 2349, 0, 1760, 0, 2349, 0, 2793, 0, 0, 0,
-        2349, 0, 2349, 0, 2349, 0, 1760, 0, 2349, 0, 0, 0,
-        
-        // Death sound
-        2093, 0, 0, 0, 0, 0, 1319, 0, 0, 0, 0, 0, 1046, 0, 0, 0, 0, 0,
-        
-        // Level complete fanfare
-        1318, 0, 1567, 0, 2093, 0, 2093, 0, 2093, 0, 2093, 0, 
-        2093, 0, 1567, 0, 1318, 0, 1046, 0, 1046, 0, 1046, 0, 
-        1046, 0, 1318, 0, 1567, 0, 2093, 0, 2093, 0, 2093, 0, 
-        2794, 0, 2794, 0, 2794, 0, 3136, 0, 0, 0, 0, 0
-    };
-    
-    int durations[] = {
-        // Main theme intro
-        100, 25, 100, 25, 100, 100, 25, 100, 100, 25, 100, 25, 100, 100, 25, 100, 200, 100,
-        
-        // Main theme part 1
-        200, 25, 175, 100, 200, 25, 100, 200, 25, 100, 150, 25, 100, 150, 25, 150, 25, 100, 150, 25, 
-        300, 25, 175, 100, 150, 25, 100, 150, 25, 100, 150, 25, 100, 150, 25, 100, 150, 25, 100, 150, 25, 150, 25, 200,
-        
-        // Main theme part 2
-        200, 25, 175, 100, 150, 25, 150, 25, 100, 200, 25, 175, 100, 150, 25, 100, 150, 25, 100, 150, 25,
-        300, 25, 175, 100, 150, 25, 150, 25, 100, 150, 25, 100, 150, 25, 100, 150, 25, 300,
-        
-        // Underground theme
-        100, 25, 100, 25, 100, 25, 100, 25, 100, 25, 100, 25, 200, 100,
-        100, 25, 100, 25, 100, 25, 100, 25, 100, 25, 100, 25, 200, 100,
-        100, 25, 100, 25, 100, 25, 100, 25, 100, 25, 100, 25, 200, 100,
-        100, 25, 100, 25, 100, 25, 100, 25, 100, 25, 100, 25, 200, 100,
-        
-        // Starman invincibility theme
-        100, 25, 100, 25, 100, 25, 100, 25, 150, 25, 150, 25, 200, 100,
-        100, 25, 100, 25, 100, 25, 100, 25, 150, 25, 200, 100,
-        100, 25, 100, 25, 100, 25, 100, 25, 150, 25, 150, 25, 200, 100,
-        100, 25, 100, 25, 100, 25, 100, 25, 150, 25, 200, 100,
-        
-        // Death sound
-        100, 25, 50, 50, 50, 50, 100, 25, 50, 50, 50, 50, 100, 25, 50, 50, 50, 200,
-        
-        // Level complete fanfare
-        150, 25, 150, 25, 150, 25, 150, 25, 150, 25, 150, 25,
-        150, 25, 150, 25, 150, 25, 150, 25, 150, 25, 150, 25,
-        150, 25, 150, 25, 150, 25, 150, 25, 150, 25, 150, 25,
-        150, 25, 150, 25, 150, 25, 300, 25, 100, 100, 100, 100
-    };
-
-    int numNotes = sizeof(melody) / sizeof(melody[0]);
-
-  for (int i = 0; i < numNotes; i++) {
-        // Lock the mutex before accessing the PWM hardware.
-        if (melody[i] != 0) {
-            initPWM(melody[i]);
-        }
-        // Release the mutex immediately after setting up the note.
-    
-        
-        // Delay for the note's specified duration.
-        delay_ms(durations[i]);
-        
-         // Disable PWM channel output if the note frequency is 0 (rest)
-         if (melody[i] == 0) {
-              TPM1_C0SC &= ~(TPM_CnSC_MSB_MASK | TPM_CnSC_ELSB_MASK); // Disconnect channel output
-         }
-     }
-    // Stop PWM after the melody finishes
-    TPM1->SC &= ~TPM_SC_CMOD_MASK; // Disable TPM1 counter
+void audio_task_init(void) {
+    audio_deadline = deadline_register("audio", BUILTIN_NOTE_MS, 1);
+    coop_add(&audio_task);
 }
+
+#endif // FEATURE_AUDIO
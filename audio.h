@@ -7,19 +7,23 @@
 // Initialize PWM with a given frequency.
 void initPWM(int frequency);
 
-// Blocking delay function (in milliseconds).
-void delay_ms(uint32_t ms);
-
 // Melody functions.
-void playtune_melody1(void);    // Example: "Mary Had a Little Lamb"
-void playtune_melody2(void);
+#define BUILTIN_NOTE_MS 500 // Every note of melody1/melody2, default of PARAM_NOTE_MS
 // Extern flag to indicate run completion
 extern volatile bool runComplete;
+// Frequency currently on the buzzer (Hz), 0 while silent.
+extern volatile uint16_t audio_note_hz;
 
+// Tempo and transpose for every melody, in twelfth-octave steps from the next
+// note on: tempo +12 plays twice as fast, transpose +12 an octave higher.
+// Both are clamped to +-AUDIO_STEPS_MAX.
+#define AUDIO_STEPS_MAX 24
+void audio_set_playback(int8_t tempo, int8_t transpose);
+int8_t audio_tempo(void);
+int8_t audio_transpose(void);
 
-void playtune_supermario(void); // Super Mario Bros theme excerpt
-
-// Audio thread function declaration
-void audio_thread(void *argument);
+// Adds the audio sequencer (built-in melodies and melodies uploaded over
+// UART, melody.h) to the coop runtime. After osKernelInitialize().
+void audio_task_init(void);
 
 #endif // AUDIO_H
@@ -0,0 +1,183 @@
+// bench.c
+#include "bench.h"
+#include "config.h"
+
+#ifdef BENCHMARK
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "MKL25Z4.h"
+#if FEATURE_LEDS
+#include "led.h"
+#include "ledanim.h"
+#endif
+#if FEATURE_MOTOR
+#include "motor.h"
+#endif
+#if FEATURE_AUDIO
+#include "audio.h"
+#include "envelope.h"
+#endif
+#if FEATURE_LINK
+#include "uart.h"
+#endif
+
+// --- Entry Points Under Test ---
+// Wrapped so that every case is a plain void(void) call; the call overhead is
+// measured with an empty case and taken off every result. A case is built in
+// with the feature of its driver.
+static void bench_empty(void)     { }
+#if FEATURE_LEDS
+static LedAnimPlayer bench_player;
+
+static void bench_green_led(void) { set_green_led(3, led_on); }
+static void bench_red_led(void)   { set_red_led(2, led_on); } // PTD, the odd port out
+static void bench_init_leds(void) { init_leds(); }
+static void bench_led_frame(void) { ledanim_step(&bench_player); } // LED task body minus RTOS calls
+#endif
+#if FEATURE_AUDIO
+static void bench_init_pwm(void)  { initPWM(440); }
+static void bench_env_note(void)  { envelope_note(ENVELOPE_HEAD_MS + ENVELOPE_RELEASE_MS); } // Table build; head and tail steps follow
+static void bench_env_step(void)  { envelope_step(); }           // TPM0 interrupt body
+#endif
+#if FEATURE_MOTOR
+static void bench_move_up(void)   { moveUp(); }
+static void bench_move_stop(void) { moveStop(); }
+#endif
+
+typedef struct {
+    const char *name;
+    void      (*fn)(void);
+} BenchCase;
+
+static const BenchCase cases[] = {
+#if FEATURE_LEDS
+    { "set_green_led", bench_green_led },
+    { "set_red_led",   bench_red_led },
+    { "init_leds",     bench_init_leds },
+    { "led_frame",     bench_led_frame },
+#endif
+#if FEATURE_AUDIO
+    { "initPWM",       bench_init_pwm },
+    { "envelope_note", bench_env_note },
+    { "envelope_step", bench_env_step },
+#endif
+#if FEATURE_MOTOR
+    { "moveUp",        bench_move_up },
+    { "moveStop",      bench_move_stop },
+#endif
+};
+#define NUM_CASES (sizeof(cases) / sizeof(cases[0]))
+
+static BenchResult results[NUM_CASES];
+#if FEATURE_LINK
+static char json[160 + NUM_CASES * 80];
+#endif
+
+// --- Timing ---
+// SysTick as a free-running 24-bit down-counter at the core clock. RTX sets
+// it up again in osKernelStart().
+static void systick_free_run(void) {
+    SysTick->CTRL = 0;
+    SysTick->LOAD = SysTick_LOAD_RELOAD_Msk;
+    SysTick->VAL = 0;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+
+static uint32_t time_call(void (*fn)(void)) {
+    uint32_t start = SysTick->VAL;
+    fn();
+    uint32_t end = SysTick->VAL;
+    return (start - end) & SysTick_LOAD_RELOAD_Msk;
+}
+
+static void measure(const char *name, void (*fn)(void), uint32_t overhead, BenchResult *out) {
+    uint32_t total = 0;
+    out->name = name;
+    out->min_cycles = UINT32_MAX;
+    out->max_cycles = 0;
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        uint32_t cycles = time_call(fn);
+        cycles = (cycles > overhead) ? cycles - overhead : 0;
+        total += cycles;
+        if (cycles < out->min_cycles) out->min_cycles = cycles;
+        if (cycles > out->max_cycles) out->max_cycles = cycles;
+    }
+    out->avg_cycles = total / BENCH_ITERATIONS;
+}
+
+// --- Report ---
+#if FEATURE_LINK
+static size_t append(size_t pos, const char *fmt, ...) {
+    if (pos >= sizeof(json) - 1) {
+        return pos;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(json + pos, sizeof(json) - pos, fmt, args);
+    va_end(args);
+    if (n < 0) {
+        return pos;
+    }
+    pos += (size_t)n;
+    return (pos < sizeof(json)) ? pos : sizeof(json) - 1;
+}
+
+static void report(void) {
+    size_t pos = append(0, "{\"bench\":\"drivers\",\"core_hz\":%lu,\"iterations\":%u,\"results\":[",
+                        (unsigned long)SystemCoreClock, (unsigned)BENCH_ITERATIONS);
+    for (uint32_t i = 0; i < NUM_CASES; i++) {
+        pos = append(pos, "%s{\"name\":\"%s\",\"min\":%lu,\"avg\":%lu,\"max\":%lu}",
+                     (i == 0) ? "" : ",", results[i].name,
+                     (unsigned long)results[i].min_cycles, (unsigned long)results[i].avg_cycles,
+                     (unsigned long)results[i].max_cycles);
+    }
+    pos = append(pos, "]}\n");
+
+    uart_tx_dma((const uint8_t *)json, pos);
+    while (uart_tx_busy()) {
+        // Send it all before the telemetry thread takes over the link.
+    }
+}
+#else
+static void report(void) {
+    // No link: read results[] with the debugger.
+}
+#endif
+
+void bench_run(void) {
+    __disable_irq();
+    systick_free_run();
+
+    // Smallest of a few empty calls: the cost of the harness itself.
+    uint32_t overhead = UINT32_MAX;
+    for (uint32_t i = 0; i < 8; i++) {
+        uint32_t cycles = time_call(bench_empty);
+        if (cycles < overhead) overhead = cycles;
+    }
+
+#if FEATURE_LEDS
+    ledanim_start(&bench_player, &ledanim_moving);
+#endif
+    for (uint32_t i = 0; i < NUM_CASES; i++) {
+        measure(cases[i].name, cases[i].fn, overhead, &results[i]);
+    }
+
+    // Leave the hardware as main() expects it.
+#if FEATURE_MOTOR
+    moveStop();
+#endif
+#if FEATURE_LEDS
+    init_leds();
+#endif
+#if FEATURE_AUDIO
+    TPM1->SC &= ~TPM_SC_CMOD_MASK;
+    envelope_off();
+#endif
+    SysTick->CTRL = 0;
+    __enable_irq();
+
+    report();
+}
+
+#endif // BENCHMARK
@@ -0,0 +1,45 @@
+// bench.h
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+// On-target driver benchmark.
+// With BENCHMARK defined, main() calls bench_run() once before the kernel
+// starts. It times every driver entry point with the SysTick counter (core
+// clock cycles, interrupts off) and sends the results over UART2 as one JSON
+// line, so successive firmware versions can be compared by a script:
+//
+//   {"bench":"drivers","core_hz":48000000,"iterations":64,"results":[
+//    {"name":"set_green_led","min":..,"avg":..,"max":..}, ...]}
+//
+// The motor entry points really drive the motor pins for a few microseconds.
+// Each case is built in with its driver's FEATURE_*, so every profile can be
+// benchmarked; without FEATURE_LINK there is no report, and the results stay
+// in bench.c's results[] for the debugger. Without BENCHMARK bench_run()
+// compiles to nothing.
+
+#ifdef BENCHMARK
+
+// --- Configuration ---
+#define BENCH_ITERATIONS 64
+
+typedef struct {
+    const char *name;
+    uint32_t    min_cycles;
+    uint32_t    avg_cycles;
+    uint32_t    max_cycles;
+} BenchResult;
+
+// --- Function Prototypes ---
+// Needs board_init() and the inits of the profile's drivers (init_leds(),
+// init_Motor(), uart_init()) done first.
+void bench_run(void);
+
+#else // !BENCHMARK
+
+#define bench_run() ((void)0)
+
+#endif // BENCHMARK
+
+#endif // BENCH_H
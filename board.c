@@ -0,0 +1,66 @@
+// board.c
+#include "board.h"
+#include "MKL25Z4.h"
+
+// --- Build-Time Checks ---
+// A pin listed twice makes the sum of a port's bits differ from their OR.
+#define BOARD_STATIC_ASSERT(cond, tag) typedef char board_assert_##tag[(cond) ? 1 : -1]
+#define BOARD_NO_CONFLICT(p) (BOARD_PORT_PIN_SUM(p) == (uint64_t)BOARD_PORT_PINS(p))
+
+BOARD_STATIC_ASSERT(BOARD_NO_CONFLICT(BOARD_PORT_A), pin_used_twice_on_port_a);
+BOARD_STATIC_ASSERT(BOARD_NO_CONFLICT(BOARD_PORT_B), pin_used_twice_on_port_b);
+BOARD_STATIC_ASSERT(BOARD_NO_CONFLICT(BOARD_PORT_C), pin_used_twice_on_port_c);
+BOARD_STATIC_ASSERT(BOARD_NO_CONFLICT(BOARD_PORT_D), pin_used_twice_on_port_d);
+BOARD_STATIC_ASSERT(BOARD_NO_CONFLICT(BOARD_PORT_E), pin_used_twice_on_port_e);
+
+// --- Generated Tables ---
+#define BOARD_MUX_ROW(p) { \
+    BOARD_PORT_MUX_PINS(p, 0), BOARD_PORT_MUX_PINS(p, 1), BOARD_PORT_MUX_PINS(p, 2), \
+    BOARD_PORT_MUX_PINS(p, 3), BOARD_PORT_MUX_PINS(p, 4), BOARD_PORT_MUX_PINS(p, 5), \
+    BOARD_PORT_MUX_PINS(p, 6), BOARD_PORT_MUX_PINS(p, 7) }
+
+// Pins per port and mux setting.
+static const uint32_t mux_pins[BOARD_NUM_PORTS][8] = {
+    BOARD_MUX_ROW(BOARD_PORT_A), BOARD_MUX_ROW(BOARD_PORT_B), BOARD_MUX_ROW(BOARD_PORT_C),
+    BOARD_MUX_ROW(BOARD_PORT_D), BOARD_MUX_ROW(BOARD_PORT_E)
+};
+
+static const uint32_t outputs[BOARD_NUM_PORTS] = {
+    BOARD_PORT_OUTPUTS(BOARD_PORT_A), BOARD_PORT_OUTPUTS(BOARD_PORT_B), BOARD_PORT_OUTPUTS(BOARD_PORT_C),
+    BOARD_PORT_OUTPUTS(BOARD_PORT_D), BOARD_PORT_OUTPUTS(BOARD_PORT_E)
+};
+
+static const uint32_t outputs_high[BOARD_NUM_PORTS] = {
+    BOARD_PORT_HIGH(BOARD_PORT_A), BOARD_PORT_HIGH(BOARD_PORT_B), BOARD_PORT_HIGH(BOARD_PORT_C),
+    BOARD_PORT_HIGH(BOARD_PORT_D), BOARD_PORT_HIGH(BOARD_PORT_E)
+};
+
+// --- Initialization ---
+// Global pin control writes one PCR value to every pin selected in the upper
+// half-word: GPCLR covers pins 0-15, GPCHR pins 16-31.
+void board_init(void) {
+    SIM->SCGC5 |= BOARD_CLOCK_MASK;
+
+    for (uint32_t p = 0; p < BOARD_NUM_PORTS; p++) {
+        PORT_Type *port = board_port(p);
+        GPIO_Type *gpio = board_gpio(p);
+
+        // Output levels first, so nothing glitches when PDDR turns them on.
+        if (outputs[p] != 0) {
+            gpio->PSOR = outputs_high[p];
+            gpio->PCOR = outputs[p] & ~outputs_high[p];
+        }
+        for (uint32_t mux = 0; mux < 8; mux++) {
+            uint32_t pins = mux_pins[p][mux];
+            if ((pins & 0x0000FFFFU) != 0) {
+                port->GPCLR = PORT_GPCLR_GPWE(pins & 0xFFFFU) | PORT_PCR_MUX(mux);
+            }
+            if ((pins & 0xFFFF0000U) != 0) {
+                port->GPCHR = PORT_GPCHR_GPWE(pins >> 16) | PORT_PCR_MUX(mux);
+            }
+        }
+        if (outputs[p] != 0) {
+            gpio->PDDR |= outputs[p];
+        }
+    }
+}
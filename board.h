@@ -0,0 +1,115 @@
+// board.h
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdint.h>
+#include "MKL25Z4.h"
+
+// Board pin map.
+// Every pin the firmware uses is listed once in BOARD_PINS. Everything else is
+// generated from it at compile time: the port clock gates, one GPCLR/GPCHR
+// write per port and mux setting instead of a read-modify-write per PCR, the
+// PDDR masks and the initial output levels. board.c also checks at build time
+// that no pin is claimed twice.
+//
+// X(ctx, name, port, pin, mux, dir, level)
+//   ctx    passed through for the generator macros below
+//   mux    PORT_PCR_MUX value (0 = analog, 1 = GPIO)
+//   dir    BOARD_IN/BOARD_OUT for GPIO, BOARD_ALT for peripheral pins
+//   level  output level after reset (the LEDs are active low)
+#define BOARD_PINS(X, ctx) \
+    X(ctx, LED_GREEN_0,   C,  7, 1, BOARD_OUT, 1) \
+    X(ctx, LED_GREEN_1,   C,  0, 1, BOARD_OUT, 1) \
+    X(ctx, LED_GREEN_2,   C,  3, 1, BOARD_OUT, 1) \
+    X(ctx, LED_GREEN_3,   C,  4, 1, BOARD_OUT, 1) \
+    X(ctx, LED_GREEN_4,   C,  5, 1, BOARD_OUT, 1) \
+    X(ctx, LED_GREEN_5,   C,  6, 1, BOARD_OUT, 1) \
+    X(ctx, LED_GREEN_6,   C, 10, 1, BOARD_OUT, 1) \
+    X(ctx, LED_GREEN_7,   C, 11, 1, BOARD_OUT, 1) \
+    X(ctx, LED_RED_0,     A,  1, 1, BOARD_OUT, 1) \
+    X(ctx, LED_RED_1,     A,  2, 1, BOARD_OUT, 1) \
+    X(ctx, LED_RED_2,     D,  4, 1, BOARD_OUT, 1) \
+    X(ctx, LED_RED_3,     A, 12, 1, BOARD_OUT, 1) \
+    X(ctx, LED_RED_4,     A,  4, 1, BOARD_OUT, 1) \
+    X(ctx, LED_RED_5,     A,  5, 1, BOARD_OUT, 1) \
+    X(ctx, LED_RED_6,     C,  8, 1, BOARD_OUT, 1) \
+    X(ctx, LED_RED_7,     C,  9, 1, BOARD_OUT, 1) \
+    X(ctx, MOTOR_LEFT_IN,   C, 12, 1, BOARD_OUT, 0) \
+    X(ctx, MOTOR_LEFT_OUT,  C, 13, 1, BOARD_OUT, 0) \
+    X(ctx, MOTOR_RIGHT_IN,  C, 16, 1, BOARD_OUT, 0) \
+    X(ctx, MOTOR_RIGHT_OUT, C, 17, 1, BOARD_OUT, 0) \
+    X(ctx, BATTERY_SENSE,     E, 20, 0, BOARD_ALT, 0) /* ADC0_SE0 */ \
+    X(ctx, MOTOR_LEFT_SENSE,  C,  1, 0, BOARD_ALT, 0) /* ADC0_SE15 */ \
+    X(ctx, MOTOR_RIGHT_SENSE, C,  2, 0, BOARD_ALT, 0) /* ADC0_SE11 */ \
+    X(ctx, OBSTACLE_ECHO, B,  2, 3, BOARD_ALT, 0) /* TPM2_CH0 capture */ \
+    X(ctx, OBSTACLE_TRIG, B,  3, 1, BOARD_OUT, 0) \
+    X(ctx, BUZZER,        B,  0, 3, BOARD_ALT, 0) /* TPM1_CH0 */ \
+    X(ctx, BUZZER_AUX,    B,  1, 3, BOARD_ALT, 0) /* TPM1_CH1 */ \
+    X(ctx, UART_TX,       E, 22, 4, BOARD_ALT, 0) /* UART2_TX */ \
+    X(ctx, UART_RX,       E, 23, 4, BOARD_ALT, 0) /* UART2_RX */
+
+#define BOARD_IN  0
+#define BOARD_OUT 1
+#define BOARD_ALT 2
+
+#define BOARD_PORT_A 0
+#define BOARD_PORT_B 1
+#define BOARD_PORT_C 2
+#define BOARD_PORT_D 3
+#define BOARD_PORT_E 4
+#define BOARD_NUM_PORTS 5
+
+// --- Per-Pin Constants ---
+// BOARD_PORT_OF_<name> and BOARD_PIN_OF_<name> for every entry.
+#define BOARD_X_ENUM(ctx, name, port, pin, mux, dir, level) \
+    BOARD_PORT_OF_##name = BOARD_PORT_##port, BOARD_PIN_OF_##name = (pin),
+enum { BOARD_PINS(BOARD_X_ENUM, 0) };
+
+#define BOARD_MASK(name) (1UL << BOARD_PIN_OF_##name)
+#define BOARD_GPIO(name) (board_gpio(BOARD_PORT_OF_##name))
+
+static inline GPIO_Type *board_gpio(uint32_t port) {
+    static GPIO_Type *const gpio[BOARD_NUM_PORTS] = { PTA, PTB, PTC, PTD, PTE };
+    return gpio[port];
+}
+
+static inline PORT_Type *board_port(uint32_t port) {
+    static PORT_Type *const pcr[BOARD_NUM_PORTS] = { PORTA, PORTB, PORTC, PORTD, PORTE };
+    return pcr[port];
+}
+
+// --- Generated Masks ---
+// Each expands to a constant expression. 64-bit so that the sum of a port's
+// bits (used by the conflict check) cannot overflow.
+#define BOARD_BIT_IF(cond, pin) ((cond) ? (1ULL << (pin)) : 0ULL)
+
+#define BOARD_X_PORT(p, name, port, pin, mux, dir, level) \
+    | BOARD_BIT_IF(BOARD_PORT_##port == (p), pin)
+#define BOARD_X_PORT_SUM(p, name, port, pin, mux, dir, level) \
+    + BOARD_BIT_IF(BOARD_PORT_##port == (p), pin)
+#define BOARD_X_PORT_MUX(pm, name, port, pin, mux, dir, level) \
+    | BOARD_BIT_IF((BOARD_PORT_##port * 8 + (mux)) == (pm), pin)
+#define BOARD_X_OUTPUT(p, name, port, pin, mux, dir, level) \
+    | BOARD_BIT_IF(BOARD_PORT_##port == (p) && (mux) == 1 && (dir) == BOARD_OUT, pin)
+#define BOARD_X_HIGH(p, name, port, pin, mux, dir, level) \
+    | BOARD_BIT_IF(BOARD_PORT_##port == (p) && (mux) == 1 && (dir) == BOARD_OUT && (level), pin)
+
+#define BOARD_PORT_PINS(p)       ((uint32_t)(0ULL BOARD_PINS(BOARD_X_PORT, p)))
+#define BOARD_PORT_PIN_SUM(p)    (0ULL BOARD_PINS(BOARD_X_PORT_SUM, p))
+#define BOARD_PORT_MUX_PINS(p, m) ((uint32_t)(0ULL BOARD_PINS(BOARD_X_PORT_MUX, (p) * 8 + (m))))
+#define BOARD_PORT_OUTPUTS(p)    ((uint32_t)(0ULL BOARD_PINS(BOARD_X_OUTPUT, p)))
+#define BOARD_PORT_HIGH(p)       ((uint32_t)(0ULL BOARD_PINS(BOARD_X_HIGH, p)))
+
+#define BOARD_CLOCK_MASK \
+    ((BOARD_PORT_PINS(BOARD_PORT_A) ? SIM_SCGC5_PORTA_MASK : 0U) | \
+     (BOARD_PORT_PINS(BOARD_PORT_B) ? SIM_SCGC5_PORTB_MASK : 0U) | \
+     (BOARD_PORT_PINS(BOARD_PORT_C) ? SIM_SCGC5_PORTC_MASK : 0U) | \
+     (BOARD_PORT_PINS(BOARD_PORT_D) ? SIM_SCGC5_PORTD_MASK : 0U) | \
+     (BOARD_PORT_PINS(BOARD_PORT_E) ? SIM_SCGC5_PORTE_MASK : 0U))
+
+// --- Function Prototypes ---
+// Clocks every used port, sets every pin's mux, output level and direction.
+// Call first thing at startup, before any driver touches its pins.
+void board_init(void);
+
+#endif // BOARD_H
@@ -0,0 +1,219 @@
+// cmdtrace.c
+#include "cmdtrace.h"
+
+#ifdef CMDTRACE
+
+#include <string.h>
+#include "MKL25Z4.h"
+#include "cobs.h"
+#include "telemetry.h"
+#include "timebase.h"
+#include "uart.h"
+
+typedef enum {
+    TRACE_IDLE,
+    TRACE_RECORDING,
+    TRACE_REPLAYING
+} TraceMode;
+
+volatile CmdTraceStats cmdtrace_stats;
+
+static uint8_t  trace_buf[CMDTRACE_BUF_SIZE];
+static uint32_t trace_len = 0;
+static TraceMode mode = TRACE_IDLE;
+static uint32_t last_us = 0;        // Time of the previous record
+
+// Replay cursor.
+static uint32_t replay_pos = 0;
+static uint32_t replay_due_us = 0;  // Due time of the record at replay_pos
+static volatile uint8_t replay_storage[64];
+static RingBuf replay_ring = RINGBUF_INIT(replay_storage);
+
+// --- Recording ---
+// Records come from the command thread (frames) and from motor_command()
+// callers (states), so appends are done with interrupts off.
+static uint32_t put_varint(uint8_t *out, uint32_t value) {
+    uint32_t n = 0;
+    while (value >= 0x80U) {
+        out[n++] = (uint8_t)(value | 0x80U);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static uint32_t get_varint(const uint8_t *in, uint32_t *pos) {
+    uint32_t value = 0;
+    for (uint32_t shift = 0; *pos < trace_len && shift < 32; shift += 7) {
+        uint8_t byte = in[(*pos)++];
+        value |= (uint32_t)(byte & 0x7FU) << shift;
+        if ((byte & 0x80U) == 0) {
+            break;
+        }
+    }
+    return value;
+}
+
+// Reserves one record and returns where the caller writes its payload.
+static uint8_t *begin_record(uint32_t t_us, uint8_t kind, uint32_t payload) {
+    uint8_t head[6];
+    uint32_t n = put_varint(head, t_us - last_us);
+    head[n++] = kind;
+    if (trace_len + n + payload > sizeof(trace_buf)) {
+        cmdtrace_stats.overflows++;
+        return NULL;
+    }
+    memcpy(&trace_buf[trace_len], head, n);
+    uint8_t *body = &trace_buf[trace_len + n];
+    trace_len += n + payload;
+    last_us = t_us;
+    cmdtrace_stats.records++;
+    return body;
+}
+
+void cmdtrace_frame(const RingBuf *ring, uint32_t frame_bytes, uint32_t t_us) {
+    if (mode != TRACE_RECORDING || ringbuf_peek(ring, 2) == CMD_CMDTRACE) {
+        return;
+    }
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint8_t *body = begin_record(t_us, CMDTRACE_REC_FRAME, frame_bytes);
+    if (body != NULL) {
+        for (uint32_t i = 0; i < frame_bytes; i++) {
+            body[i] = ringbuf_peek(ring, i);
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+void cmdtrace_state(uint8_t state, uint32_t t_us) {
+    if (mode != TRACE_RECORDING) {
+        return;
+    }
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint8_t *body = begin_record(t_us, CMDTRACE_REC_STATE, 1);
+    if (body != NULL) {
+        body[0] = state;
+    }
+    __set_PRIMASK(primask);
+}
+
+// --- Replay ---
+// Skips STATE records (they are results, not inputs) and sets the due time
+// of the next FRAME record. Returns false at the end of the trace.
+static bool replay_seek_frame(void) {
+    while (replay_pos < trace_len) {
+        replay_due_us += get_varint(trace_buf, &replay_pos);
+        if (replay_pos >= trace_len) {
+            break;
+        }
+        uint8_t kind = trace_buf[replay_pos++];
+        if (kind == CMDTRACE_REC_FRAME) {
+            return true;
+        }
+        replay_pos += 1; // STATE payload
+    }
+    return false;
+}
+
+static void replay_start(void) {
+    replay_pos = 0;
+    replay_due_us = timebase_now_us();
+    mode = replay_seek_frame() ? TRACE_REPLAYING : TRACE_IDLE;
+}
+
+uint32_t cmdtrace_replay_poll(void) {
+    while (mode == TRACE_REPLAYING) {
+        uint32_t now = timebase_now_us();
+        int32_t wait_us = (int32_t)(replay_due_us - now);
+        if (wait_us > 0) {
+            return ((uint32_t)wait_us + 999U) / 1000U; // Woken on the tick at or after the due time
+        }
+        uint32_t late = (uint32_t)-wait_us;
+        if (late > cmdtrace_stats.replay_late_max_us) {
+            cmdtrace_stats.replay_late_max_us = late;
+        }
+
+        // Frame bytes: SYNC LEN CMD ARG.. CHK.
+        uint32_t bytes = (replay_pos + 1 < trace_len) ? CMD_FRAME_BYTES(trace_buf[replay_pos + 1]) : 0;
+        if (bytes == 0 || replay_pos + bytes > trace_len || bytes > sizeof(replay_storage)) {
+            mode = TRACE_IDLE; // Corrupt upload
+            break;
+        }
+        for (uint32_t i = 0; i < bytes; i++) {
+            ringbuf_put(&replay_ring, trace_buf[replay_pos + i]);
+        }
+        replay_pos += bytes;
+        cmdtrace_stats.replayed++;
+        command_poll(&replay_ring, now);
+
+        if (!replay_seek_frame()) {
+            mode = TRACE_IDLE;
+        }
+    }
+    return osWaitForever;
+}
+
+// --- Dump ---
+static uint8_t dump_packet[COBS_MAX_ENCODED(3 + CMDTRACE_DUMP_CHUNK) + 1];
+
+static void dump_uart(void) {
+    uint8_t chunk[3 + CMDTRACE_DUMP_CHUNK];
+    for (uint32_t offset = 0; offset < trace_len; offset += CMDTRACE_DUMP_CHUNK) {
+        uint32_t n = trace_len - offset;
+        if (n > CMDTRACE_DUMP_CHUNK) {
+            n = CMDTRACE_DUMP_CHUNK;
+        }
+        chunk[0] = TELEMETRY_TYPE_CMDTRACE;
+        chunk[1] = (uint8_t)offset;
+        chunk[2] = (uint8_t)(offset >> 8);
+        memcpy(&chunk[3], &trace_buf[offset], n);
+
+        while (uart_tx_busy()) {
+            osDelay(1);
+        }
+        uint32_t encoded = cobs_encode(chunk, 3 + n, dump_packet);
+        dump_packet[encoded++] = 0x00;
+        while (!uart_tx_dma(dump_packet, encoded)) {
+            osDelay(1); // Telemetry got the link first
+        }
+    }
+}
+
+// --- Control ---
+void cmdtrace_control(const CommandFrame *frame) {
+    uint8_t op = (frame->len >= 1) ? command_arg(frame, 0) : 0xFF;
+    switch (op) {
+        case 0: // Record
+            mode = TRACE_IDLE;
+            trace_len = 0;
+            last_us = timebase_now_us();
+            mode = TRACE_RECORDING;
+            break;
+        case 1: // Stop
+            mode = TRACE_IDLE;
+            break;
+        case 2: // Replay
+            mode = TRACE_IDLE;
+            replay_start();
+            break;
+        case 3: // Dump
+            dump_uart();
+            break;
+        case 4: // Load: start an upload
+            mode = TRACE_IDLE;
+            trace_len = 0;
+            break;
+        case 5: // Load: append
+            for (uint32_t i = 1; i < frame->len && trace_len < sizeof(trace_buf); i++) {
+                trace_buf[trace_len++] = command_arg(frame, i);
+            }
+            break;
+        default:
+            command_stats.bad_length++;
+            break;
+    }
+}
+
+#endif // CMDTRACE
@@ -0,0 +1,68 @@
+// cmdtrace.h
+#ifndef CMDTRACE_H
+#define CMDTRACE_H
+
+#include <stdint.h>
+#include "cmsis_os2.h"
+#include "ringbuf.h"
+#include "command.h"
+
+// Command session recorder.
+// With CMDTRACE defined, the firmware can record every received command frame
+// and every robot_state change with its time, and later feed the recorded
+// frames back to the decoder on the same schedule. Replaying one session on
+// two firmware versions gives the same workload, so command_stats latency and
+// the motor response can be compared directly.
+//
+// Buffer format, one record after another:
+//   varint  time since the previous record, us (LEB128, 7 bits per byte)
+//   uint8   CMDTRACE_REC_FRAME, then the raw frame (SYNC LEN CMD ARG.. CHK)
+//        or CMDTRACE_REC_STATE, then the new RobotState
+//
+// Controlled with CMD_CMDTRACE, ARG[0]:
+//   0 record (clears the buffer)   1 stop   2 replay
+//   3 dump: telemetry packets of TELEMETRY_TYPE_CMDTRACE, each
+//     [type][offset lo][offset hi][up to CMDTRACE_DUMP_CHUNK bytes]
+//   4 load: clear the buffer for upload   5 append ARG[1..] to the buffer
+// Frames of CMD_CMDTRACE itself are never recorded.
+
+#ifdef CMDTRACE
+
+// --- Configuration ---
+#define CMDTRACE_BUF_SIZE    1024
+#define CMDTRACE_DUMP_CHUNK  64
+
+#define CMDTRACE_REC_FRAME   0x01
+#define CMDTRACE_REC_STATE   0x02
+
+typedef struct {
+    uint32_t records;
+    uint32_t overflows;        // Records dropped, buffer full
+    uint32_t replayed;         // Frames fed back during replay
+    uint32_t replay_late_max_us; // Worst lateness of a replayed frame
+} CmdTraceStats;
+
+extern volatile CmdTraceStats cmdtrace_stats;
+
+// --- Function Prototypes ---
+// Hooks (no-ops unless recording).
+void     cmdtrace_frame(const RingBuf *ring, uint32_t frame_bytes, uint32_t t_us);
+void     cmdtrace_state(uint8_t state, uint32_t t_us);
+
+void     cmdtrace_control(const CommandFrame *frame);
+// Called by the command thread before it blocks: feeds every frame that is
+// due and returns the ticks until the next one (osWaitForever when idle).
+uint32_t cmdtrace_replay_poll(void);
+
+#define CMDTRACE_FRAME(ring, bytes, t_us) cmdtrace_frame((ring), (bytes), (t_us))
+#define CMDTRACE_STATE(state, t_us)       cmdtrace_state((uint8_t)(state), (t_us))
+
+#else // !CMDTRACE
+
+#define CMDTRACE_FRAME(ring, bytes, t_us) ((void)0)
+#define CMDTRACE_STATE(state, t_us)       ((void)0)
+#define cmdtrace_replay_poll()            osWaitForever
+
+#endif // CMDTRACE
+
+#endif // CMDTRACE_H
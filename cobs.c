@@ -0,0 +1,27 @@
+// cobs.c
+#include "cobs.h"
+
+size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t code_pos = 0;   // Where the current block's length byte goes
+    size_t out_pos = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code_pos] = code;
+            code_pos = out_pos++;
+            code = 1;
+        } else {
+            out[out_pos++] = in[i];
+            code++;
+            if (code == 0xFF) {
+                // Block full: close it without an implied zero.
+                out[code_pos] = code;
+                code_pos = out_pos++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+    return out_pos;
+}
@@ -0,0 +1,17 @@
+// cobs.h
+#ifndef COBS_H
+#define COBS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Consistent Overhead Byte Stuffing: removes every 0x00 from a record so that
+// 0x00 can mark the end of each frame on the wire. Encoding adds one byte per
+// started block of 254 input bytes.
+#define COBS_MAX_ENCODED(len) ((len) + ((len) / 254U) + 1U)
+
+// Encodes len bytes from in into out (at least COBS_MAX_ENCODED(len) bytes).
+// Does not append the 0x00 delimiter. Returns the encoded length.
+size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out);
+
+#endif // COBS_H
@@ -0,0 +1,198 @@
+// command.c
+#include "config.h"
+
+#if FEATURE_LINK
+
+#include "command.h"
+#include "cmsis_os2.h"
+#include "audio.h"
+#include "motor.h"
+#include "uart.h"
+#include "timebase.h"
+#include "melody.h"
+#include "wavetrace.h"
+#include "cmdtrace.h"
+#include "obstacle.h"
+#include "envelope.h"
+#include "params.h"
+
+volatile CommandStats command_stats;
+
+// --- Handlers ---
+#if FEATURE_MOTOR
+static void handle_move(const CommandFrame *frame) {
+    static const RobotState direction_to_state[] = {
+        ROBOT_STATIONARY,       // CMD_DIR_STOP
+        ROBOT_MOVING_FORWARD,   // CMD_DIR_FORWARD
+        ROBOT_MOVING_BACK,      // CMD_DIR_BACK
+        ROBOT_MOVING_LEFT,      // CMD_DIR_LEFT
+        ROBOT_MOVING_RIGHT      // CMD_DIR_RIGHT
+    };
+    if (frame->len < 1 || command_arg(frame, 0) > CMD_DIR_RIGHT) {
+        command_stats.bad_length++;
+        return;
+    }
+    motor_command(direction_to_state[command_arg(frame, 0)], frame->rx_us);
+}
+
+static void handle_obstacle(const CommandFrame *frame) {
+    if (frame->len < 3 || command_arg(frame, 2) > OBSTACLE_REFLEX_STOP) {
+        command_stats.bad_length++;
+        return;
+    }
+    uint16_t mm = (uint16_t)(command_arg(frame, 0) | (command_arg(frame, 1) << 8));
+    obstacle_set_reflex(mm, (ObstacleReflex)command_arg(frame, 2));
+}
+#endif
+
+#if FEATURE_AUDIO
+static void handle_volume(const CommandFrame *frame) {
+    if (frame->len < 1) {
+        command_stats.bad_length++;
+        return;
+    }
+    envelope_set_volume(fix_gamma8(command_arg(frame, 0)));
+}
+
+static void handle_playback(const CommandFrame *frame) {
+    if (frame->len < 2) {
+        command_stats.bad_length++;
+        return;
+    }
+    audio_set_playback((int8_t)command_arg(frame, 0), (int8_t)command_arg(frame, 1));
+}
+#endif
+
+static void handle_param(const CommandFrame *frame) {
+    if (frame->len < 5) {
+        command_stats.bad_length++;
+        return;
+    }
+    uint32_t value = command_arg(frame, 1) | (command_arg(frame, 2) << 8) |
+                     (command_arg(frame, 3) << 16) | ((uint32_t)command_arg(frame, 4) << 24);
+    if (command_arg(frame, 0) >= PARAM_COUNT || !params_set((ParamId)command_arg(frame, 0), (int32_t)value)) {
+        command_stats.bad_length++; // Unknown key or out of range (flash errors and refusals count in params_stats)
+    }
+}
+
+#ifdef WAVETRACE
+static void handle_wavetrace(const CommandFrame *frame) {
+    uint8_t op = (frame->len >= 1) ? command_arg(frame, 0) : 0xFF;
+    switch (op) {
+        case 0: wavetrace_start(); break;
+        case 1: wavetrace_stop(); break;
+        case 2: wavetrace_dump_uart(); break; // Holds up the decoder until sent
+        default: command_stats.bad_length++; break;
+    }
+}
+#endif
+
+static void dispatch(const CommandFrame *frame) {
+    switch (frame->cmd) {
+#if FEATURE_MOTOR
+        case CMD_MOVE:
+            handle_move(frame);
+            break;
+        case CMD_OBSTACLE:
+            handle_obstacle(frame);
+            break;
+#endif
+        case CMD_RUN_COMPLETE:
+            runComplete = (frame->len >= 1) && (command_arg(frame, 0) != 0);
+            break;
+        case CMD_PARAM:
+            handle_param(frame);
+            break;
+#if FEATURE_AUDIO
+        case CMD_VOLUME:
+            handle_volume(frame);
+            break;
+        case CMD_PLAYBACK:
+            handle_playback(frame);
+            break;
+        case CMD_MELODY_DATA:
+            melody_write(frame->ring, 3, frame->len); // Arguments start after SYNC, LEN, CMD
+            break;
+#endif
+#ifdef WAVETRACE
+        case CMD_WAVETRACE:
+            handle_wavetrace(frame);
+            break;
+#endif
+#ifdef CMDTRACE
+        case CMD_CMDTRACE:
+            cmdtrace_control(frame);
+            break;
+#endif
+        default:
+            command_stats.unknown++;
+            break;
+    }
+}
+
+// --- Decoder ---
+// Works directly on the ring: bytes are only peeked until a whole frame has
+// arrived and checked, then the frame is handled in place and skipped.
+void command_poll(RingBuf *ring, uint32_t rx_us) {
+    for (;;) {
+        uint32_t avail = ringbuf_count(ring);
+        if (avail == 0) {
+            return;
+        }
+        if (ringbuf_peek(ring, 0) != CMD_SYNC) {
+            ringbuf_skip(ring, 1);
+            command_stats.skipped_bytes++;
+            continue;
+        }
+        if (avail < 2) {
+            return;
+        }
+        uint8_t len = ringbuf_peek(ring, 1);
+        if (len > CMD_MAX_ARGS) {
+            // Not a real frame start; resynchronise on the next SYNC.
+            ringbuf_skip(ring, 1);
+            command_stats.bad_length++;
+            continue;
+        }
+        if (avail < CMD_FRAME_BYTES(len)) {
+            return; // Wait for the rest
+        }
+
+        uint8_t sum = 0;
+        for (uint32_t i = 1; i < 3U + len; i++) {
+            sum += ringbuf_peek(ring, i);
+        }
+        uint8_t check = (uint8_t)~sum;
+        if (check != ringbuf_peek(ring, 3U + len)) {
+            ringbuf_skip(ring, 1);
+            command_stats.bad_checksum++;
+            continue;
+        }
+
+        CommandFrame frame = { ring, ringbuf_peek(ring, 2), len, rx_us };
+        command_stats.frames++;
+        CMDTRACE_FRAME(ring, CMD_FRAME_BYTES(len), rx_us);
+        dispatch(&frame);
+        ringbuf_skip(ring, CMD_FRAME_BYTES(len));
+    }
+}
+
+void command_actuated(uint32_t rx_us) {
+    uint32_t latency = timebase_now_us() - rx_us;
+    command_stats.latency_last_us = latency;
+    if (latency > command_stats.latency_max_us) {
+        command_stats.latency_max_us = latency;
+    }
+}
+
+// --- Command Thread ---
+void command_thread(void *argument) {
+    uart_set_rx_thread(osThreadGetId());
+    for (;;) {
+        // Also wakes for the next replayed frame when a session replay runs.
+        osThreadFlagsWait(UART_FLAG_RX, osFlagsWaitAny, cmdtrace_replay_poll());
+        command_poll(&uart_rx, uart_last_rx_us());
+    }
+}
+
+#endif // FEATURE_LINK
@@ -0,0 +1,68 @@
+// command.h
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ringbuf.h"
+
+// --- Frame Format ---
+//   SYNC  LEN  CMD  ARG[0..LEN-1]  CHK
+// LEN counts ARG bytes only. CHK = ~(LEN + CMD + sum(ARG)) & 0xFF.
+#define CMD_SYNC         0xA5
+#define CMD_MAX_ARGS     32
+#define CMD_FRAME_BYTES(len) ((len) + 4U)
+
+// --- Command Codes ---
+#define CMD_MOVE          0x01  // ARG[0] = CmdDirection
+#define CMD_RUN_COMPLETE  0x02  // ARG[0] = 0/1, selects the end-of-run melody
+#define CMD_MELODY_DATA   0x03  // ARG = up to 16 notes, 2 bytes each (melody.h)
+#define CMD_WAVETRACE     0x04  // ARG[0] = 0 start, 1 stop, 2 dump as VCD (WAVETRACE builds)
+#define CMD_CMDTRACE      0x05  // Session record/replay, see cmdtrace.h (CMDTRACE builds)
+#define CMD_OBSTACLE      0x06  // ARG[0..1] = stop distance mm (LE), ARG[2] = ObstacleReflex
+#define CMD_VOLUME        0x07  // ARG[0] = volume 0..255, perceptual (gamma 2.2)
+#define CMD_PLAYBACK      0x08  // ARG[0] = tempo, ARG[1] = transpose; int8 semitone steps
+#define CMD_PARAM         0x09  // ARG[0] = ParamId, ARG[1..4] = value (int32 LE), stored in flash
+
+typedef enum {
+    CMD_DIR_STOP,
+    CMD_DIR_FORWARD,
+    CMD_DIR_BACK,
+    CMD_DIR_LEFT,
+    CMD_DIR_RIGHT
+} CmdDirection;
+
+// A decoded frame, still sitting in the receive ring. Arguments are read in
+// place with command_arg(); the frame is only valid inside the handler.
+typedef struct {
+    const RingBuf *ring;
+    uint8_t        cmd;
+    uint8_t        len;
+    uint32_t       rx_us;   // Timebase stamp of the frame's last byte (approx.)
+} CommandFrame;
+
+static inline uint8_t command_arg(const CommandFrame *frame, uint32_t index) {
+    return ringbuf_peek(frame->ring, 3 + index);
+}
+
+typedef struct {
+    uint32_t frames;
+    uint32_t bad_checksum;
+    uint32_t bad_length;
+    uint32_t unknown;
+    uint32_t skipped_bytes;    // Bytes discarded while hunting for SYNC
+    uint32_t latency_last_us;  // Last byte received -> motor pins written
+    uint32_t latency_max_us;
+} CommandStats;
+
+extern volatile CommandStats command_stats;
+
+// --- Function Prototypes ---
+void command_thread(void *argument);
+// Decodes and dispatches every complete frame in 'ring'. Leaves a partial frame
+// in place. Exposed so a host build can feed an in-memory stream.
+void command_poll(RingBuf *ring, uint32_t rx_us);
+// Called by the motor layer once the pins reflect the command stamped rx_us.
+void command_actuated(uint32_t rx_us);
+
+#endif // COMMAND_H
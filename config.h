@@ -0,0 +1,60 @@
+// config.h
+#ifndef CONFIG_H
+#define CONFIG_H
+
+// Build profiles.
+// One source set builds every variant of the firmware: define one PROFILE_*
+// for the target (none = PROFILE_ROBOT). A profile sets the FEATURE_* flags
+// below. A module whose feature is off compiles to nothing, and main() neither
+// initialises it nor starts its thread, so its code, tables and stack are not
+// in the image.
+//   PROFILE_ROBOT      The full robot
+//   PROFILE_LED_AUDIO  LED + audio bench: animations and melodies, no motors
+//                      and no UART; a demo thread cycles robot_state and
+//                      runComplete in place of the motor thread
+//   PROFILE_MOTOR      Motors with the obstacle reflex and power monitor,
+//                      driven over the UART; no LEDs, no buzzer
+//
+// Flags (0/1, test with #if):
+//   FEATURE_MOTOR       motor.c, obstacle.c, powermon.c and the motor thread
+//   FEATURE_LINK        uart.c, command.c, telemetry.c and their threads
+//   FEATURE_LEDS        led.c, ledanim.c and the LED task
+//   FEATURE_AUDIO       audio.c, melody.c, envelope.c and the audio task
+//   FEATURE_COOP        coop.c, musclock.c and the coop thread (LEDs or audio)
+//   FEATURE_STATE_DEMO  The demo thread of PROFILE_LED_AUDIO
+
+#if (defined(PROFILE_ROBOT) + defined(PROFILE_LED_AUDIO) + defined(PROFILE_MOTOR)) > 1
+#error "Define at most one PROFILE_*"
+#endif
+
+#if defined(PROFILE_LED_AUDIO)
+#define FEATURE_MOTOR       0
+#define FEATURE_LINK        0
+#define FEATURE_LEDS        1
+#define FEATURE_AUDIO       1
+#define FEATURE_STATE_DEMO  1
+#elif defined(PROFILE_MOTOR)
+#define FEATURE_MOTOR       1
+#define FEATURE_LINK        1
+#define FEATURE_LEDS        0
+#define FEATURE_AUDIO       0
+#define FEATURE_STATE_DEMO  0
+#else // PROFILE_ROBOT
+#define FEATURE_MOTOR       1
+#define FEATURE_LINK        1
+#define FEATURE_LEDS        1
+#define FEATURE_AUDIO       1
+#define FEATURE_STATE_DEMO  0
+#endif
+
+#define FEATURE_COOP        (FEATURE_LEDS || FEATURE_AUDIO)
+
+// --- Dependencies ---
+#if FEATURE_MOTOR && !FEATURE_LINK
+#error "The motors are only commanded over the UART link"
+#endif
+#if (defined(WAVETRACE) || defined(CMDTRACE)) && !FEATURE_LINK
+#error "WAVETRACE and CMDTRACE send over the UART link"
+#endif
+
+#endif // CONFIG_H
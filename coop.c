@@ -0,0 +1,115 @@
+// coop.c
+#include "config.h"
+
+#if FEATURE_COOP
+
+#include "coop.h"
+#include "timebase.h"
+
+osThreadId_t coop_thread_id = NULL;
+
+static CoopTask *tasks[COOP_MAX_TASKS];
+static uint32_t num_tasks = 0;
+static uint32_t pending = 0;     // Signals received and not yet handed to a task
+
+void coop_add(CoopTask *task) {
+    if (num_tasks < COOP_MAX_TASKS) {
+        tasks[num_tasks++] = task;
+    }
+}
+
+void coop_signal(uint32_t signals) {
+    if (coop_thread_id != NULL) {
+        osThreadFlagsSet(coop_thread_id, signals & COOP_SIGNALS);
+    }
+}
+
+void coop_clear(uint32_t signals) {
+    osThreadFlagsClear(signals & COOP_SIGNALS);
+    pending &= ~signals;
+}
+
+// --- Scheduling ---
+// Moves newly raised thread flags into the pending set.
+static void collect_signals(void) {
+    uint32_t flags = osThreadFlagsClear(COOP_SIGNALS);
+    if ((flags & osFlagsError) == 0) {
+        pending |= flags & COOP_SIGNALS;
+    }
+}
+
+// Earliest-deadline ready task, or NULL with the time to the next wake-up in
+// *sleep_us (INT32_MAX when every task has ended).
+static CoopTask *pick(uint32_t now, int32_t *sleep_us) {
+    CoopTask *best = NULL;
+    int32_t best_key = 0;
+    *sleep_us = INT32_MAX;
+
+    for (uint32_t i = 0; i < num_tasks; i++) {
+        CoopTask *t = tasks[i];
+        if (t->ended) {
+            continue;
+        }
+        int32_t until = (int32_t)(t->wake_us - now);
+        if (until > 0 && (pending & t->wait_signals) == 0) {
+            if (until < *sleep_us) {
+                *sleep_us = until;
+            }
+            continue;
+        }
+        // Released at its wake-up time, or now if a signal came first.
+        int32_t key = ((until > 0) ? 0 : until) + (int32_t)t->deadline_us;
+        if (best == NULL || key < best_key) {
+            best = t;
+            best_key = key;
+        }
+    }
+    return best;
+}
+
+static void run_task(CoopTask *t, uint32_t now) {
+    t->signals = pending & t->wait_signals;
+    pending &= ~t->signals;
+    if (t->signals == 0) {
+        uint32_t late = now - t->wake_us;
+        if (late > t->late_max_us) {
+            t->late_max_us = late;
+        }
+    }
+
+    uint32_t start = timebase_now_us();
+    if (t->run(t) == COOP_ENDED) {
+        t->ended = true;
+    }
+    uint32_t exec = timebase_now_us() - start;
+    t->runs++;
+    t->exec_us += exec;
+    if (exec > t->exec_max_us) {
+        t->exec_max_us = exec;
+    }
+}
+
+// --- Runtime Thread ---
+// Sleeps on its thread flags until the next wake-up. It never spins: the
+// timeout is rounded up to whole kernel ticks, so a task starts up to one
+// tick (1 ms) after its wake-up time, and the CPU can idle meanwhile.
+void coop_thread(void *argument) {
+    coop_thread_id = osThreadGetId();
+    for (;;) {
+        collect_signals();
+        uint32_t now = timebase_now_us();
+        int32_t sleep_us;
+        CoopTask *t = pick(now, &sleep_us);
+        if (t != NULL) {
+            run_task(t, now);
+        } else if (sleep_us == INT32_MAX) {
+            osThreadFlagsWait(COOP_SIGNALS, osFlagsWaitAny | osFlagsNoClear, osWaitForever);
+        } else {
+            // A wait of n ticks ends after n - 1 to n ms; an early return just
+            // goes round again with the rest.
+            osThreadFlagsWait(COOP_SIGNALS, osFlagsWaitAny | osFlagsNoClear, (uint32_t)sleep_us / 1000U + 1U);
+        }
+    }
+}
+
+#endif // FEATURE_COOP
@@ -0,0 +1,84 @@
+// coop.h
+#ifndef COOP_H
+#define COOP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmsis_os2.h"
+#include "timebase.h"
+
+// Cooperative task runtime.
+// Light periodic jobs (audio sequencing, LED animation) run as stackless
+// protothreads inside one RTOS thread, coop_thread, instead of one thread and
+// stack each. A task is a function that resumes where it last yielded; it
+// yields with a wake-up time and, optionally, a set of signals that end the
+// wait early. Among the ready tasks the one with the earliest deadline
+// (wake-up time + its relative deadline) runs next, to its next yield.
+// Wake-ups are kernel-tick granular: a task starts up to 1 ms late, and the
+// sequences absorb that by timing against absolute end times.
+//
+// Signals are the coop thread's own thread flags, so other threads and ISRs
+// raise them with osThreadFlagsSet(coop_thread_id, bits) and tasks in the
+// runtime with coop_signal().
+//
+// Rules for task bodies:
+//   - Locals do not survive a yield; keep state in the task's context.
+//   - No switch statements between COOP_BEGIN and COOP_END (the resume
+//     points are case labels).
+//   - Blocking RTOS calls stall every task; only short mutex sections.
+
+// --- Configuration ---
+#define COOP_MAX_TASKS   4
+#define COOP_SIGNALS     0x0000FFFFU  // Thread flags used as signals
+
+#define COOP_WAITING     0
+#define COOP_ENDED       1
+
+typedef struct CoopTask CoopTask;
+typedef int8_t (*CoopFn)(CoopTask *task);
+
+struct CoopTask {
+    const char *name;
+    CoopFn      run;
+    uint32_t    deadline_us;    // Relative to the wake-up time, for EDF
+    // Runtime state.
+    uint16_t    lc;             // Resume point (source line), 0 = start
+    bool        ended;
+    uint32_t    wake_us;
+    uint32_t    wait_signals;
+    uint32_t    signals;        // Signals that ended the last wait (0 = timed out)
+    // Statistics.
+    uint32_t    runs;
+    uint64_t    exec_us;        // Total time running, for the CPU share
+    uint32_t    exec_max_us;
+    uint32_t    late_max_us;    // Worst start after the wake-up time
+};
+
+#define COOP_TASK(name, fn, deadline_us) { (name), (fn), (deadline_us), 0, false, 0, 0, 0, 0, 0, 0, 0 }
+
+// --- Task Body Macros ---
+#define COOP_BEGIN(task)  switch ((task)->lc) { case 0:
+#define COOP_END(task)    } (task)->lc = 0; return COOP_ENDED
+
+// Yields until timebase time at_us, or until one of sigmask arrives.
+#define COOP_WAIT_UNTIL(task, at_us, sigmask) \
+    do { \
+        (task)->wake_us = (at_us); \
+        (task)->wait_signals = (sigmask); \
+        (task)->lc = __LINE__; \
+        return COOP_WAITING; \
+        case __LINE__:; \
+    } while (0)
+
+#define COOP_SLEEP_UNTIL(task, at_us)          COOP_WAIT_UNTIL(task, at_us, 0U)
+#define COOP_WAIT_SIGNAL(task, sigmask, us)    COOP_WAIT_UNTIL(task, timebase_now_us() + (us), sigmask)
+
+extern osThreadId_t coop_thread_id;
+
+// --- Function Prototypes ---
+void coop_add(CoopTask *task);         // Before the coop thread starts
+void coop_signal(uint32_t signals);    // Any context
+void coop_clear(uint32_t signals);     // From a task: drops signals nobody consumed
+void coop_thread(void *argument);
+
+#endif // COOP_H
@@ -0,0 +1,152 @@
+// deadline.c
+#include "deadline.h"
+#include "cmsis_os2.h"
+#include <string.h>
+
+// Internal bookkeeping is in kernel system-timer cycles; only deadline_get()
+// converts to microseconds.
+typedef struct {
+    const char *name;
+    uint32_t period;
+    uint32_t budget;
+    uint32_t expected;      // Expected release of the current/next job
+    uint32_t released_at;
+    bool     synced;        // false until the first release of a phase
+    uint32_t jobs;
+    uint32_t overruns;
+    uint32_t misses;
+    uint32_t max_jitter;
+    uint32_t max_exec;
+    uint32_t max_response;
+} DeadlineTask;
+
+static DeadlineTask tasks[DEADLINE_MAX_TASKS];
+static uint32_t num_tasks = 0;
+static DeadlineMissHook miss_hook = NULL;
+
+static uint32_t ms_to_cycles(uint32_t ms) {
+    return (osKernelGetSysTimerFreq() / 1000U) * ms;
+}
+
+static uint32_t cycles_to_us(uint32_t cycles) {
+    uint32_t per_us = osKernelGetSysTimerFreq() / 1000000U;
+    return cycles / (per_us != 0 ? per_us : 1);
+}
+
+int deadline_register(const char *name, uint32_t period_ms, uint32_t budget_ms) {
+    int32_t lock = osKernelLock();
+    int task = -1;
+    if (num_tasks < DEADLINE_MAX_TASKS) {
+        task = (int)num_tasks++;
+    }
+    osKernelRestoreLock(lock);
+    if (task < 0) {
+        return -1;
+    }
+
+    DeadlineTask *t = &tasks[task];
+    memset(t, 0, sizeof(*t));
+    t->name = name;
+    t->period = ms_to_cycles(period_ms);
+    t->budget = ms_to_cycles(budget_ms);
+    return task;
+}
+
+void deadline_set_period(int task, uint32_t period_ms) {
+    if (task >= 0 && (uint32_t)task < num_tasks) {
+        tasks[task].period = ms_to_cycles(period_ms);
+    }
+}
+
+void deadline_resync(int task) {
+    if (task >= 0 && (uint32_t)task < num_tasks) {
+        tasks[task].synced = false;
+    }
+}
+
+void deadline_set_miss_hook(DeadlineMissHook hook) {
+    miss_hook = hook;
+}
+
+// --- Job boundaries ---
+// Each task's entry is only written by the task itself, so no locking is needed.
+static void release_at(int task, uint32_t now) {
+    if (task < 0 || (uint32_t)task >= num_tasks) {
+        return;
+    }
+    DeadlineTask *t = &tasks[task];
+
+    if (!t->synced) {
+        t->expected = now;
+        t->synced = true;
+    }
+    int32_t lateness = (int32_t)(now - t->expected);
+    if (lateness < 0) {
+        // Released ahead of the period (sporadic job): not jitter, and the
+        // new job's deadline counts from now.
+        t->expected = now;
+    } else if ((uint32_t)lateness > t->max_jitter) {
+        t->max_jitter = (uint32_t)lateness;
+    }
+    t->released_at = now;
+}
+
+void deadline_release(int task) {
+    release_at(task, osKernelGetSysTimerCount());
+}
+
+void deadline_release_ago(int task, uint32_t ago_us) {
+    uint32_t per_us = osKernelGetSysTimerFreq() / 1000000U;
+    release_at(task, osKernelGetSysTimerCount() - ago_us * per_us);
+}
+
+void deadline_complete(int task) {
+    if (task < 0 || (uint32_t)task >= num_tasks) {
+        return;
+    }
+    DeadlineTask *t = &tasks[task];
+    uint32_t now = osKernelGetSysTimerCount();
+    uint32_t exec = now - t->released_at;
+    int32_t late = (int32_t)(now - t->expected);
+    uint32_t response = (late > 0) ? (uint32_t)late : 0U;
+
+    t->jobs++;
+    if (exec > t->max_exec) {
+        t->max_exec = exec;
+    }
+    if (response > t->max_response) {
+        t->max_response = response;
+    }
+    if (t->budget != 0 && exec > t->budget) {
+        t->overruns++;
+    }
+
+    t->expected += t->period;
+    if ((int32_t)(now - t->expected) > 0) {
+        // Finished after the deadline. The next job cannot start earlier than
+        // now, so re-phase instead of reporting the same miss again as jitter.
+        t->misses++;
+        t->expected = now;
+        if (miss_hook != NULL) {
+            miss_hook(task);
+        }
+    }
+}
+
+// --- Readout ---
+void deadline_get(int task, DeadlineStats *out) {
+    memset(out, 0, sizeof(*out));
+    if (task < 0 || (uint32_t)task >= num_tasks) {
+        return;
+    }
+    const DeadlineTask *t = &tasks[task];
+    out->name = t->name;
+    out->period_us = cycles_to_us(t->period);
+    out->budget_us = cycles_to_us(t->budget);
+    out->jobs = t->jobs;
+    out->overruns = t->overruns;
+    out->misses = t->misses;
+    out->max_jitter_us = cycles_to_us(t->max_jitter);
+    out->max_exec_us = cycles_to_us(t->max_exec);
+    out->max_response_us = cycles_to_us(t->max_response);
+}
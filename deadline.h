@@ -0,0 +1,44 @@
+// deadline.h
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Deadline monitor for periodic loops.
+// A task calls deadline_release() when a job starts and deadline_complete()
+// when its work is done (before it sleeps). The deadline of a job is the end of
+// its period, measured from the expected release time, so release jitter and a
+// slow job both count towards a miss. A sporadic job started by an input can
+// be released at the input's time stamp with deadline_release_ago(), so the
+// deadline covers the latency from the input instead.
+
+// --- Configuration ---
+#define DEADLINE_MAX_TASKS 6
+
+// --- Per-task statistics (microseconds) ---
+typedef struct {
+    const char *name;
+    uint32_t period_us;
+    uint32_t budget_us;
+    uint32_t jobs;
+    uint32_t overruns;          // Jobs whose execution time exceeded the budget
+    uint32_t misses;            // Jobs that completed after their deadline
+    uint32_t max_jitter_us;     // Largest actual - expected release (early releases re-phase)
+    uint32_t max_exec_us;       // Largest release-to-complete time
+    uint32_t max_response_us;   // Largest expected-release-to-complete time
+} DeadlineStats;
+
+typedef void (*DeadlineMissHook)(int task);
+
+// --- Function Prototypes ---
+int  deadline_register(const char *name, uint32_t period_ms, uint32_t budget_ms); // Returns task handle or -1
+void deadline_set_period(int task, uint32_t period_ms); // Applies to the next deadline_release()
+void deadline_resync(int task);    // Next release starts a new phase (after a dormant gap)
+void deadline_release(int task);
+void deadline_release_ago(int task, uint32_t ago_us); // Job started ago_us before now (an input's stamp)
+void deadline_complete(int task);
+void deadline_set_miss_hook(DeadlineMissHook hook); // Called from the missing task's context
+void deadline_get(int task, DeadlineStats *out);
+
+#endif // DEADLINE_H
@@ -0,0 +1,152 @@
+// envelope.c
+#include "config.h"
+
+#if FEATURE_AUDIO
+
+#include "envelope.h"
+#include "MKL25Z4.h"
+#include "timebase.h"
+
+#define ENVELOPE_TPM      TPM0
+#define STEP_COUNTS       ((TIMEBASE_TPM_CLOCK_HZ / 1000000U) * ENVELOPE_STEP_US)
+#define HOP_MAX_STEPS     (65536U / STEP_COUNTS)  // Longest period the 16-bit MOD holds
+#define VOLUME_FULL       ((q15_t)0x7FFF)
+
+volatile EnvelopeStats envelope_stats;
+
+// --- Shapes (Q15 of full level = 50% duty) ---
+// 4 ms linear attack, then a decay that settles at the sustain level (the
+// last entry).
+static const q15_t head_shape[ENVELOPE_HEAD_MS] = {
+    Q15(0.25), Q15(0.50), Q15(0.75), VOLUME_FULL,
+    Q15(0.92), Q15(0.86), Q15(0.81), Q15(0.77), Q15(0.73), Q15(0.70),
+    Q15(0.67), Q15(0.65), Q15(0.63), Q15(0.62), Q15(0.61), Q15(0.60)
+};
+
+// Release, as a fraction of the sustain level; ends silent.
+static const q15_t release_shape[ENVELOPE_RELEASE_MS] = {
+    Q15(0.85), Q15(0.70), Q15(0.57), Q15(0.46), Q15(0.36), Q15(0.28),
+    Q15(0.21), Q15(0.15), Q15(0.10), Q15(0.06), Q15(0.03), 0
+};
+
+// --- Per-Note Tables ---
+// C0V values for the current note. Only written while TPM0 is stopped.
+static uint16_t head[ENVELOPE_HEAD_MS];
+static uint16_t tail[ENVELOPE_RELEASE_MS];
+static volatile uint32_t step_pos = 0;              // Steps since the note started
+static volatile uint32_t release_at = UINT32_MAX;  // Step at which the tail starts
+static volatile uint32_t tick_steps = 0;           // Period in MOD, 0 = stopped
+static volatile q15_t volume = VOLUME_FULL;
+
+static void tick_stop(void) {
+    ENVELOPE_TPM->SC = TPM_SC_TOF_MASK; // Counter off, pending overflow cleared
+    // An overflow already latched in the NVIC would still run the handler and
+    // step the note that envelope_note() is about to set up.
+    NVIC_ClearPendingIRQ(TPM0_IRQn);
+    tick_steps = 0;
+}
+
+// Overflows every 'steps' steps from now. A running counter keeps its period
+// (no drift); a new period restarts it, as MOD only loads at once while off.
+static void tick_every(uint32_t steps) {
+    if (steps == tick_steps) {
+        return;
+    }
+    tick_stop();
+    ENVELOPE_TPM->MOD = steps * STEP_COUNTS - 1U;
+    ENVELOPE_TPM->CNT = 0;
+    ENVELOPE_TPM->SC = TPM_SC_TOF_MASK | TPM_SC_TOIE_MASK | TPM_SC_PS(3) | TPM_SC_CMOD(1);
+    tick_steps = steps;
+}
+
+void envelope_init(void) {
+    // Clock source (TPMSRC) is already set up by timebase_init().
+    SIM->SCGC6 |= SIM_SCGC6_TPM0_MASK;
+    tick_stop();
+    NVIC_SetPriority(TPM0_IRQn, 2);
+    NVIC_ClearPendingIRQ(TPM0_IRQn);
+    NVIC_EnableIRQ(TPM0_IRQn);
+}
+
+// level (Q15) of full volume to a C0V value for this note's period.
+static inline uint16_t duty_for(q15_t level, uint32_t half_period) {
+    return (uint16_t)(((uint32_t)level * half_period) >> 15);
+}
+
+void envelope_note(uint32_t duration_ms) {
+    tick_stop();
+    uint32_t half_period = (TPM1->MOD + 1U) >> 1;
+    q15_t vol = volume;
+    for (uint32_t i = 0; i < ENVELOPE_HEAD_MS; i++) {
+        head[i] = duty_for(q15_mul(head_shape[i], vol), half_period);
+    }
+    q15_t sustain = q15_mul(head_shape[ENVELOPE_HEAD_MS - 1], vol);
+    for (uint32_t i = 0; i < ENVELOPE_RELEASE_MS; i++) {
+        tail[i] = duty_for(q15_mul(release_shape[i], sustain), half_period);
+    }
+
+    if (duration_ms == 0) {
+        release_at = UINT32_MAX;
+    } else {
+        release_at = (duration_ms > ENVELOPE_RELEASE_MS) ? duration_ms - ENVELOPE_RELEASE_MS : 0;
+    }
+    step_pos = 0;
+    envelope_step(); // First value now; arms TPM0 for the next
+    envelope_stats.notes++;
+}
+
+void envelope_off(void) {
+    tick_stop();
+}
+
+void envelope_set_volume(q15_t level) {
+    volume = (level > 0) ? level : 0; // Applies from the next note
+}
+
+q15_t envelope_volume(void) {
+    return volume;
+}
+
+// --- Stepping ---
+// Steps from step t to the next one that has work, 0 = none: every step of
+// the head and the tail, across the sustain in hops of at most HOP_MAX_STEPS
+// to the release, none after the last tail entry or for a held note.
+static uint32_t next_hop(uint32_t t) {
+    if (t >= release_at) {
+        return (t - release_at + 1U < ENVELOPE_RELEASE_MS) ? 1U : 0U;
+    }
+    if (t + 1U < ENVELOPE_HEAD_MS) {
+        return 1U;
+    }
+    if (release_at == UINT32_MAX) {
+        return 0U;
+    }
+    uint32_t gap = release_at - t;
+    return (gap < HOP_MAX_STEPS) ? gap : HOP_MAX_STEPS;
+}
+
+void envelope_step(void) {
+    uint32_t t = step_pos;
+    if (t >= release_at) {
+        TPM1->CONTROLS[0].CnV = tail[t - release_at];
+        envelope_stats.steps++;
+    } else if (t < ENVELOPE_HEAD_MS) {
+        TPM1->CONTROLS[0].CnV = head[t];
+        envelope_stats.steps++;
+    } // Else a hop through the sustain: C0V holds the last head entry
+
+    uint32_t hop = next_hop(t);
+    if (hop == 0) {
+        tick_stop(); // Faded out or held: C0V stays as it is
+        return;
+    }
+    step_pos = t + hop;
+    tick_every(hop);
+}
+
+void TPM0_IRQHandler(void) {
+    ENVELOPE_TPM->SC |= TPM_SC_TOF_MASK; // Write 1 to clear
+    envelope_step();
+}
+
+#endif // FEATURE_AUDIO
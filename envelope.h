@@ -0,0 +1,44 @@
+// envelope.h
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <stdint.h>
+#include "fixmath.h"
+
+// Note amplitude envelopes on the buzzer.
+// The buzzer's loudness follows the TPM1 channel 0 duty, so every note gets an
+// attack/decay head, a sustain level and a release tail by stepping C0V once
+// per millisecond from TPM0's overflow interrupt. TPM0 counts the shared
+// 1 MHz TPM clock (OSCERCLK, on in VLPS) and only runs while there are steps
+// to take: through the sustain it is re-armed to overflow at the release (in
+// hops of up to 65 ms), and a note held until the next stops it after the
+// head, so a long note costs a few interrupts instead of one per millisecond.
+//
+// At note start envelope_note() turns the Q15 shape tables below into C0V
+// values for this note's period and the global volume: one multiply per
+// entry, no division. The interrupt then only copies a table entry per step.
+// A note's last ENVELOPE_RELEASE_MS fade out, so back-to-back notes are
+// separated even without a rest.
+
+// --- Configuration ---
+#define ENVELOPE_STEP_US     1000
+#define ENVELOPE_HEAD_MS     16     // Attack + decay entries
+#define ENVELOPE_RELEASE_MS  12
+
+typedef struct {
+    uint32_t notes;
+    uint32_t steps;         // Steps that wrote C0V
+} EnvelopeStats;
+
+extern volatile EnvelopeStats envelope_stats;
+
+// --- Function Prototypes ---
+void  envelope_init(void);
+// Call right after initPWM(). duration_ms = 0 sustains until the next note.
+void  envelope_note(uint32_t duration_ms);
+void  envelope_off(void);            // Stops stepping (buzzer stopped)
+void  envelope_set_volume(q15_t volume);
+q15_t envelope_volume(void);
+void  envelope_step(void);           // One step; the TPM0 interrupt body
+
+#endif // ENVELOPE_H
@@ -0,0 +1,104 @@
+// fixmath.c
+#include "fixmath.h"
+
+// --- Reciprocal Table ---
+// recip_table[i] = 2^31 / dn at the middle of the bin dn = (128 + i) << 8,
+// for a divisor normalised to [2^15, 2^16). Good to about 8 bits.
+static const uint16_t recip_table[128] = {
+    65281, 64777, 64281, 63792, 63310, 62836, 62369, 61909,
+    61455, 61008, 60568, 60133, 59705, 59283, 58867, 58457,
+    58053, 57654, 57260, 56872, 56489, 56111, 55738, 55370,
+    55007, 54649, 54295, 53946, 53601, 53261, 52925, 52593,
+    52265, 51942, 51622, 51306, 50995, 50686, 50382, 50081,
+    49784, 49490, 49200, 48913, 48630, 48349, 48072, 47798,
+    47528, 47260, 46995, 46733, 46474, 46218, 45965, 45714,
+    45467, 45222, 44979, 44739, 44502, 44267, 44035, 43805,
+    43577, 43352, 43129, 42908, 42690, 42474, 42260, 42048,
+    41838, 41631, 41425, 41222, 41020, 40820, 40623, 40427,
+    40233, 40041, 39851, 39662, 39476, 39291, 39108, 38926,
+    38746, 38568, 38392, 38217, 38044, 37872, 37702, 37533,
+    37366, 37200, 37036, 36873, 36712, 36552, 36393, 36236,
+    36080, 35926, 35772, 35620, 35470, 35320, 35172, 35026,
+    34880, 34735, 34592, 34450, 34309, 34169, 34031, 33893,
+    33757, 33622, 33487, 33354, 33222, 33091, 32961, 32832,
+};
+
+uint32_t fix_udiv16(uint32_t n, uint16_t d) {
+    if (d == 0) {
+        return UINT32_MAX;
+    }
+
+    // Normalise: dn = d << s has bit 15 set. No CLZ on the M0+, so halve the
+    // search range instead.
+    uint32_t dn = d;
+    uint32_t s = 0;
+    if (dn < 0x0100U) { dn <<= 8; s += 8; }
+    if (dn < 0x1000U) { dn <<= 4; s += 4; }
+    if (dn < 0x4000U) { dn <<= 2; s += 2; }
+    if (dn < 0x8000U) { dn <<= 1; s += 1; }
+
+    // r ~ 2^31 / dn, refined once: r += r * (2^31 - dn * r) / 2^31.
+    uint32_t r = recip_table[(dn >> 8) - 128U];
+    int32_t err = (int32_t)(0x80000000U - dn * r);
+    r = (uint32_t)((int32_t)r + (((int32_t)r * (err >> 8)) >> 23));
+    if (r > 0xFFFFU) {
+        r = 0xFFFFU; // Only at dn = 2^15; keeps the partial products in 32 bits
+    }
+
+    // q = (n * r) >> (31 - s), from two 16x16 partial products.
+    uint32_t hi = (n >> 16) * r;
+    uint32_t lo = (n & 0xFFFFU) * r;
+    uint32_t sum = hi + (lo >> 16);        // (n * r) >> 16, carry-free
+    uint32_t q = sum >> (15 - s);
+
+    // The estimate is a little low or high; fix it up while q * d is exact.
+    if (q <= 0xFFFFU) {
+        uint32_t prod = q * d;
+        while (prod > n) {
+            q--;
+            prod -= d;
+        }
+        while (n - prod >= d) {
+            q++;
+            prod += d;
+        }
+    }
+    return q;
+}
+
+// --- Gamma Table ---
+// round(32767 * (i / 16)^2.2), i = 0..16.
+static const q15_t gamma_table[17] = {
+    0, 74, 338, 824, 1552, 2536, 3787, 5316, 7131,
+    9241, 11651, 14369, 17401, 20751, 24426, 28430, 32767
+};
+
+q15_t fix_gamma8(uint8_t level) {
+    uint32_t i = level >> 4;
+    q15_t t = (q15_t)((level & 0x0FU) << 11);  // Fraction of the segment in Q15
+    if (level == 255) {
+        return gamma_table[16];
+    }
+    return q15_lerp(gamma_table[i], gamma_table[i + 1], t);
+}
+
+// --- Semitone Table ---
+// round(32768 * 2^(k / 12)), k = 0..11: one octave, scaled by shifts.
+static const uint16_t semitone_table[12] = {
+    32768, 34716, 36781, 38968, 41285, 43740,
+    46341, 49097, 52016, 55109, 58386, 61858
+};
+
+uint32_t fix_scale_semitones(uint32_t x, int32_t steps) {
+    int32_t octave = 0;
+    while (steps < 0) {
+        steps += 12;
+        octave--;
+    }
+    while (steps >= 12) {
+        steps -= 12;
+        octave++;
+    }
+    uint32_t y = (x * semitone_table[steps] + 16384U) >> 15;
+    return (octave >= 0) ? (y << octave) : ((y + (1U << (-octave - 1))) >> -octave);
+}
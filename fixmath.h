@@ -0,0 +1,80 @@
+// fixmath.h
+#ifndef FIXMATH_H
+#define FIXMATH_H
+
+#include <stdint.h>
+
+// Fixed-point helpers for the Cortex-M0+ (no FPU, no divide instruction).
+//   q15_t  signed 1.15, range [-1, 1)
+//   q16_t  signed 16.16
+// Cycle budgets are for the KL25Z at 48 MHz with the single-cycle multiplier,
+// zero wait-state flash excluded; 64-bit products go through __aeabi_lmul.
+
+typedef int16_t q15_t;
+typedef int32_t q16_t;
+
+#define Q15_ONE_MINUS   ((q15_t)0x7FFF)
+#define Q16_ONE         ((q16_t)0x00010000)
+#define Q15(x)          ((q15_t)((x) * 32768.0 + ((x) >= 0 ? 0.5 : -0.5)))  // Constants only
+#define Q16(x)          ((q16_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))  // Constants only
+
+// --- Saturation ---
+static inline q15_t q15_sat(int32_t x) {
+    if (x > INT16_MAX) return INT16_MAX;
+    if (x < INT16_MIN) return INT16_MIN;
+    return (q15_t)x;
+}
+
+// --- Q15 --- (each ~5-8 cycles)
+static inline q15_t q15_add_sat(q15_t a, q15_t b) {
+    return q15_sat((int32_t)a + b);
+}
+
+// Rounded; -1 * -1 saturates to just under 1.
+static inline q15_t q15_mul(q15_t a, q15_t b) {
+    return q15_sat(((int32_t)a * b + (1 << 14)) >> 15);
+}
+
+// a + (b - a) * t, t in [0, 1).
+static inline q15_t q15_lerp(q15_t a, q15_t b, q15_t t) {
+    int32_t diff = (int32_t)b - a;
+    return (q15_t)(a + ((diff * t + (1 << 14)) >> 15));
+}
+
+// --- Q16.16 ---
+static inline q16_t q16_add_sat(q16_t a, q16_t b) { // ~8 cycles
+    int32_t sum = (int32_t)((uint32_t)a + (uint32_t)b);
+    if (((a ^ sum) & (b ^ sum)) < 0) {  // Both operands differ in sign from the sum
+        return (a < 0) ? INT32_MIN : INT32_MAX;
+    }
+    return sum;
+}
+
+// Rounded, not saturated. ~30 cycles.
+static inline q16_t q16_mul(q16_t a, q16_t b) {
+    return (q16_t)(((int64_t)a * b + 0x8000) >> 16);
+}
+
+// a + (b - a) * t, t in [0, 1] as Q16.16. ~35 cycles.
+static inline q16_t q16_lerp(q16_t a, q16_t b, q16_t t) {
+    return a + q16_mul(b - a, t);
+}
+
+// --- Division and Tables (fixmath.c) ---
+// n / d rounded down, using a reciprocal table and one Newton-Raphson step
+// instead of the library divide (~40 cycles against ~100 for __aeabi_uidiv).
+// Exact while the quotient fits 16 bits; above that the relative error is
+// below 2^-14. d = 0 returns UINT32_MAX.
+uint32_t fix_udiv16(uint32_t n, uint16_t d);
+
+// Perceptual brightness: level 0..255 to a linear Q15 duty with gamma 2.2,
+// from a 17-point table with linear interpolation (within 0.8% of full
+// scale of the exact curve). ~15 cycles.
+q15_t fix_gamma8(uint8_t level);
+
+// x * 2^(steps / 12), rounded: a 12-entry Q15 semitone table plus shifts, for
+// transposing frequencies and scaling durations by tempo steps. x below 2^16;
+// within 2^-15 relative plus one unit of rounding. ~20 cycles.
+uint32_t fix_scale_semitones(uint32_t x, int32_t steps);
+
+#endif // FIXMATH_H
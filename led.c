@@ -1,108 +1,98 @@
 // led.c
+#include "config.h"
+
+#if FEATURE_LEDS
+
 #include "led.h" // Include the header file
 #include "RTE_Components.h" // Still needed for some definitions potentially
 #include "MKL25Z4.h"
 #include "cmsis_os2.h"
 #include <stdbool.h>
-
-// --- Helper Macro --- (Keep Helper Macro)
-#define MASK(x) (1UL << (x))
-
-/* Delay Function */
-static void delay (volatile uint32_t nof) {
-    while (nof!=0) {
-        asm("NOP");
-        nof--;
-    }
-}
+#include "mutexprof.h"
+#include "deadline.h"
+#include "board.h"
+#include "ledanim.h"
+#include "wavetrace.h"
+#include "musclock.h"
+#include "coop.h"
+#include "timebase.h"
+#include "params.h"
+#include "portout.h"
+
+// --- LED Pins ---
+typedef struct {
+    uint8_t  port;   // BOARD_PORT_x
+    uint32_t mask;
+} LedPin;
+
+#define LED_PIN(name) { BOARD_PORT_OF_##name, BOARD_MASK(name) }
+
+static const LedPin green_leds[NUM_GREEN_LEDS] = {
+    LED_PIN(LED_GREEN_0), LED_PIN(LED_GREEN_1), LED_PIN(LED_GREEN_2), LED_PIN(LED_GREEN_3),
+    LED_PIN(LED_GREEN_4), LED_PIN(LED_GREEN_5), LED_PIN(LED_GREEN_6), LED_PIN(LED_GREEN_7)
+};
+
+static const LedPin red_leds[NUM_RED_LEDS] = {
+    LED_PIN(LED_RED_0), LED_PIN(LED_RED_1), LED_PIN(LED_RED_2), LED_PIN(LED_RED_3),
+    LED_PIN(LED_RED_4), LED_PIN(LED_RED_5), LED_PIN(LED_RED_6), LED_PIN(LED_RED_7)
+};
 
 // --- LED Initialization ---
+// Clocks, mux and direction come from board_init(); this only sets the state.
 void init_leds(void) {
-    // Enable clock to ports used by LEDs (Port A, Port C, and Port D)
-    SIM->SCGC5 |= SIM_SCGC5_PORTA_MASK | SIM_SCGC5_PORTC_MASK | SIM_SCGC5_PORTD_MASK;
-
-		// Configuring MUX = 001 for GPIO
-    // --- Configure Green LEDs (All on Port C) ---
-    PORTC->PCR[GREEN_LED_0] = (PORTC->PCR[GREEN_LED_0] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTC->PCR[GREEN_LED_1] = (PORTC->PCR[GREEN_LED_1] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTC->PCR[GREEN_LED_2] = (PORTC->PCR[GREEN_LED_2] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTC->PCR[GREEN_LED_3] = (PORTC->PCR[GREEN_LED_3] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTC->PCR[GREEN_LED_4] = (PORTC->PCR[GREEN_LED_4] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTC->PCR[GREEN_LED_5] = (PORTC->PCR[GREEN_LED_5] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTC->PCR[GREEN_LED_6] = (PORTC->PCR[GREEN_LED_6] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTC->PCR[GREEN_LED_7] = (PORTC->PCR[GREEN_LED_7] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-		// Set direction to output
-    GREEN_LED_PORT->PDDR |= (MASK(GREEN_LED_0) | MASK(GREEN_LED_1) | MASK(GREEN_LED_2) | MASK(GREEN_LED_3) |
-                             MASK(GREEN_LED_4) | MASK(GREEN_LED_5) | MASK(GREEN_LED_6) | MASK(GREEN_LED_7));
-
-    // --- Configure Red LEDs (Split across Port A, C and D) ---
-		PORTA->PCR[RED_LED_0] = (PORTA->PCR[RED_LED_0] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTA->PCR[RED_LED_1] = (PORTA->PCR[RED_LED_1] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTD->PCR[RED_LED_2] = (PORTD->PCR[RED_LED_2] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1); // Port D
-    PORTA->PCR[RED_LED_3] = (PORTA->PCR[RED_LED_3] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTA->PCR[RED_LED_4] = (PORTA->PCR[RED_LED_4] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTA->PCR[RED_LED_5] = (PORTA->PCR[RED_LED_5] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    PORTC->PCR[RED_LED_6] = (PORTC->PCR[RED_LED_6] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-		PORTC->PCR[RED_LED_7] = (PORTC->PCR[RED_LED_7] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
-    RED_LED_PORT_A->PDDR   |= (MASK(RED_LED_0) | MASK(RED_LED_1) | MASK(RED_LED_3) | MASK(RED_LED_4) | MASK(RED_LED_5));
-    RED_LED_PORT_C->PDDR   |= (MASK(RED_LED_6) | MASK(RED_LED_7));
-    RED_LED_PORT_D->PDDR   |= MASK(RED_LED_2); // Port D
-
-    // Turn off all LEDs initially
     all_green_leds_off();
     for(int i = 0; i < NUM_RED_LEDS; i++){
         set_red_led(i, led_off); // Use helper function
     }
 }
 
+// Clear bit to turn LED on, set bit to turn it off (active low).
+static void set_led(const LedPin *led, int state) {
+    GPIO_Type *gpio = board_gpio(led->port);
+    if (state == led_on) {
+        gpio->PCOR = led->mask;
+    } else {
+        gpio->PSOR = led->mask;
+    }
+}
 
 // --- Helper function for setting individual green LED state ---
 void set_green_led(int index, int state) {
-		// Clear bit to turn LED on (active low)
-		// Set bit to turn LED off (active low)
-    switch(index) {
-        case 0: GREEN_LED_PORT->PCOR = (state == led_on) ? MASK(GREEN_LED_0) : 0; GREEN_LED_PORT->PSOR = (state == led_off) ? MASK(GREEN_LED_0) : 0; break;
-        case 1: GREEN_LED_PORT->PCOR = (state == led_on) ? MASK(GREEN_LED_1) : 0; GREEN_LED_PORT->PSOR = (state == led_off) ? MASK(GREEN_LED_1) : 0; break;
-        case 2: GREEN_LED_PORT->PCOR = (state == led_on) ? MASK(GREEN_LED_2) : 0; GREEN_LED_PORT->PSOR = (state == led_off) ? MASK(GREEN_LED_2) : 0; break;
-        case 3: GREEN_LED_PORT->PCOR = (state == led_on) ? MASK(GREEN_LED_3) : 0; GREEN_LED_PORT->PSOR = (state == led_off) ? MASK(GREEN_LED_3) : 0; break;
-        case 4: GREEN_LED_PORT->PCOR = (state == led_on) ? MASK(GREEN_LED_4) : 0; GREEN_LED_PORT->PSOR = (state == led_off) ? MASK(GREEN_LED_4) : 0; break;
-        case 5: GREEN_LED_PORT->PCOR = (state == led_on) ? MASK(GREEN_LED_5) : 0; GREEN_LED_PORT->PSOR = (state == led_off) ? MASK(GREEN_LED_5) : 0; break;
-        case 6: GREEN_LED_PORT->PCOR = (state == led_on) ? MASK(GREEN_LED_6) : 0; GREEN_LED_PORT->PSOR = (state == led_off) ? MASK(GREEN_LED_6) : 0; break;
-        case 7: GREEN_LED_PORT->PCOR = (state == led_on) ? MASK(GREEN_LED_7) : 0; GREEN_LED_PORT->PSOR = (state == led_off) ? MASK(GREEN_LED_7) : 0; break;
+    if (index >= 0 && index < NUM_GREEN_LEDS) {
+        set_led(&green_leds[index], state);
+        WAVE_SET_BIT(WAVE_LEDS, index, state == led_on);
     }
 }
 
 // --- Helper function for setting individual red LED state ---
-//  This needs to handle LEDs on *different* ports.
+// The red LEDs are spread over three ports; the table holds the port per LED.
 void set_red_led(int index, int state) {
-  switch(index) {
-      case 0: RED_LED_PORT_A->PCOR = (state == led_on) ? MASK(RED_LED_0) : 0; RED_LED_PORT_A->PSOR = (state == led_off) ? MASK(RED_LED_0) : 0; break;
-      case 1: RED_LED_PORT_A->PCOR = (state == led_on) ? MASK(RED_LED_1) : 0; RED_LED_PORT_A->PSOR = (state == led_off) ? MASK(RED_LED_1) : 0; break;
-      case 2: RED_LED_PORT_D->PCOR = (state == led_on) ? MASK(RED_LED_2) : 0; RED_LED_PORT_D->PSOR = (state == led_off) ? MASK(RED_LED_2) : 0; break; // Port D
-      case 3: RED_LED_PORT_A->PCOR = (state == led_on) ? MASK(RED_LED_3) : 0; RED_LED_PORT_A->PSOR = (state == led_off) ? MASK(RED_LED_3) : 0; break;
-      case 4: RED_LED_PORT_A->PCOR = (state == led_on) ? MASK(RED_LED_4) : 0; RED_LED_PORT_A->PSOR = (state == led_off) ? MASK(RED_LED_4) : 0; break;
-      case 5: RED_LED_PORT_A->PCOR = (state == led_on) ? MASK(RED_LED_5) : 0; RED_LED_PORT_A->PSOR = (state == led_off) ? MASK(RED_LED_5) : 0; break;
-      case 6: RED_LED_PORT_C->PCOR = (state == led_on) ? MASK(RED_LED_6) : 0; RED_LED_PORT_C->PSOR = (state == led_off) ? MASK(RED_LED_6) : 0; break;
-      case 7: RED_LED_PORT_C->PCOR = (state == led_on) ? MASK(RED_LED_7) : 0; RED_LED_PORT_C->PSOR = (state == led_off) ? MASK(RED_LED_7) : 0; break;
-  }
+    if (index >= 0 && index < NUM_RED_LEDS) {
+        set_led(&red_leds[index], state);
+        WAVE_SET_BIT(WAVE_LEDS, NUM_GREEN_LEDS + index, state == led_on);
+    }
 }
 
 
-
-// --- LED Control Functions ---
-
-void running_green_leds(void) {
-    static int current_led = 0; // Keep track of the currently lit LED
-
-    // Turn off all LEDs except the current one
-    for (int i = 0; i < NUM_GREEN_LEDS; i++) {
-        set_green_led(i, (i == current_led) ? led_on : led_off);
+// --- Batched Update ---
+// One portout commit for all the LEDs in mask, so a frame costs at most a
+// PCOR and a PSOR write per port.
+void set_leds(uint16_t leds, uint16_t mask) {
+    PortOutBatch batch = PORTOUT_BATCH_INIT;
+    for (int i = 0; mask != 0; i++, mask >>= 1, leds >>= 1) {
+        if ((mask & 1U) == 0) {
+            continue;
+        }
+        const LedPin *led = (i < NUM_GREEN_LEDS) ? &green_leds[i] : &red_leds[i - NUM_GREEN_LEDS];
+        // Active low: a lit LED is a cleared bit.
+        portout_stage(&batch, led->port, led->mask, (leds & 1U) ? 0U : led->mask);
+        WAVE_SET_BIT(WAVE_LEDS, i, (leds & 1U) != 0);
     }
-
-    current_led = (current_led + 1) % NUM_GREEN_LEDS; // Move to the next LED (circular)
-    osDelay(100); // Adjust delay for the running speed (e.g., 100ms)
+    portout_commit(&batch);
 }
 
+// --- LED Control Functions ---
+
 void all_green_leds_on(void) {
     for (int i = 0; i < NUM_GREEN_LEDS; i++) {
         set_green_led(i, led_on);
@@ -115,40 +105,81 @@ void all_green_leds_off(void) {
     }
 }
 
-void red_leds_moving_flash(void) {
-    static bool leds_state = false;
-    for (int i = 0; i < NUM_RED_LEDS; i++) {
-        set_red_led(i, leds_state ? led_off : led_on);
+// --- LED Task ---
+// Runs in the coop runtime (coop.h). Frames are timed by the animation until
+// music plays. From then on the task waits for the musical clock and steps
+// one frame per onset: every note for the chase, every beat for the
+// stationary flash. MUSCLOCK_FLAG_STOP hands timing back to the animation.
+
+#define LED_SYNC_POLL_MS 100 // robot_state check while waiting for onsets
+#define LED_DEADLINE_US  2000
+
+// Kept across yields.
+static struct {
+  int           deadline;
+  LedAnimPlayer player;
+  RobotState    last_state;
+  uint32_t      next_us;
+} led = { -1, { &ledanim_stationary, 0, 0 }, ROBOT_STATIONARY, 0 }; // init_leds() left all LEDs off
+
+static int8_t led_task_run(CoopTask *task) {
+  COOP_BEGIN(task);
+  led.next_us = timebase_now_us();
+  for (;;) {
+    deadline_release(led.deadline);
+    // Acquire mutex to protect access to robot_state
+    MUTEX_ACQUIRE(robot_state_mutex, osWaitForever); // Access mutex declared in main.c via led.h
+    RobotState current_state = robot_state; // Make a local copy
+    MUTEX_RELEASE(robot_state_mutex);
+
+    if (current_state != led.last_state) {
+        // Any direction counts as moving. A new state restarts its animation at once.
+        ledanim_start(&led.player, (current_state != ROBOT_STATIONARY) ? &ledanim_moving
+                                                                       : &ledanim_stationary);
+        led.next_us = timebase_now_us();
+        deadline_resync(led.deadline);
+        led.last_state = current_state;
     }
-    leds_state = !leds_state;
-    osDelay(500);
-}
-
-void red_leds_stationary_flash(void) {
-    static bool leds_state = false;
-    for (int i = 0; i < NUM_RED_LEDS; i++) {
-        set_red_led(i, leds_state ? led_off : led_on);
+    bool synced = musclock_playing();
+    uint32_t onset = (led.player.anim == &ledanim_stationary) ? MUSCLOCK_FLAG_BEAT : MUSCLOCK_FLAG_NOTE;
+    uint32_t frame_ms = 0;
+    if (!synced || (task->signals & onset) != 0) {
+      // Frame times as authored, scaled by PARAM_LED_SCALE (Q8).
+      frame_ms = (ledanim_step(&led.player) * (uint32_t)params_get(PARAM_LED_SCALE)) >> 8;
+      if (synced) {
+        musclock_followed();
+      }
+    }
+    deadline_complete(led.deadline);
+
+    if (synced) {
+      // Onsets are not periodic; only the frame work itself is checked.
+      deadline_resync(led.deadline);
+      coop_clear((MUSCLOCK_FLAG_NOTE | MUSCLOCK_FLAG_BEAT) & ~onset);
+      COOP_WAIT_SIGNAL(task, onset | MUSCLOCK_FLAG_STOP, LED_SYNC_POLL_MS * 1000U);
+      led.next_us = timebase_now_us();
+      continue;
     }
-    leds_state = !leds_state;
-    osDelay(250);
+    // One job per frame; the next frame is released when this one ends, or
+    // straight away when the first note of a melody starts.
+    deadline_set_period(led.deadline, frame_ms);
+    led.next_us += frame_ms * 1000U;
+    coop_clear(MUSCLOCK_FLAG_BEAT | MUSCLOCK_FLAG_STOP);
+    COOP_WAIT_UNTIL(task, led.next_us, MUSCLOCK_FLAG_NOTE);
+    if (task->signals != 0) {
+      task->signals |= MUSCLOCK_FLAG_BEAT; // The first note of a melody is on a beat
+      led.next_us = timebase_now_us();
+      deadline_resync(led.deadline);
+    }
+  }
+  COOP_END(task);
 }
 
-// --- LED Control Thread ---
+static CoopTask led_task = COOP_TASK("led", led_task_run, LED_DEADLINE_US);
 
-void led_control_thread(void *argument) {
-  for (;;) {
-    // Acquire mutex to protect access to robot_state
-    osMutexAcquire(robot_state_mutex, osWaitForever); // Access mutex declared in main.c via led.h
-    RobotState current_state = robot_state; // Make a local copy
-    osMutexRelease(robot_state_mutex);
-
-        if (current_state == ROBOT_MOVING) {
-            running_green_leds();
-            red_leds_moving_flash();
-        } else { // ROBOT_STATIONARY
-            all_green_leds_on();
-            red_leds_stationary_flash();
-        }
-    osDelay(10); // Add a small delay (e.g., 10ms) to prevent busy-waiting
-  }
+void led_task_init(void) {
+  led.deadline = deadline_register("led", LEDANIM_UNIT_MS, 1);
+  coop_add(&led_task);
 }
+
+#endif // FEATURE_LEDS
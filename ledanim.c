@@ -0,0 +1,93 @@
+// ledanim.c
+#include "config.h"
+
+#if FEATURE_LEDS
+
+#include "ledanim.h"
+#include "MKL25Z4.h"
+#include "led.h"
+
+volatile LedAnimStats ledanim_stats;
+
+// --- Animations ---
+// Moving: a green LED chases round the ring while all red LEDs blink,
+// 100 ms per chase step plus 510 ms per red toggle (610 ms per step).
+// 8 steps x 2 frames = 33 bytes instead of 48 for raw 3-byte frames.
+static const uint8_t moving_frames[] = {
+    LEDANIM_FULL(100, 0x01, 0x00),  // G0........   red off
+    LEDANIM_XOR_RED(510, 0xFF),     //              red on
+    LEDANIM_XOR_GREEN(100, 0x03),   // .G1.......
+    LEDANIM_XOR_RED(510, 0xFF),     //              red off
+    LEDANIM_XOR_GREEN(100, 0x06),   // ..G2......
+    LEDANIM_XOR_RED(510, 0xFF),
+    LEDANIM_XOR_GREEN(100, 0x0C),   // ...G3.....
+    LEDANIM_XOR_RED(510, 0xFF),
+    LEDANIM_XOR_GREEN(100, 0x18),   // ....G4....
+    LEDANIM_XOR_RED(510, 0xFF),
+    LEDANIM_XOR_GREEN(100, 0x30),   // .....G5...
+    LEDANIM_XOR_RED(510, 0xFF),
+    LEDANIM_XOR_GREEN(100, 0x60),   // ......G6..
+    LEDANIM_XOR_RED(510, 0xFF),
+    LEDANIM_XOR_GREEN(100, 0xC0),   // .......G7.
+    LEDANIM_XOR_RED(510, 0xFF)      //              red off, back to G0
+};
+
+// Stationary: all green on, red blinks at 260 ms. 5 bytes.
+static const uint8_t stationary_frames[] = {
+    LEDANIM_FULL(260, 0xFF, 0xFF),
+    LEDANIM_XOR_RED(260, 0xFF)
+};
+
+LEDANIM_DEFINE(ledanim_moving, moving_frames);
+LEDANIM_DEFINE(ledanim_stationary, stationary_frames);
+
+// --- Player ---
+// Only LEDs whose bit changed are written, in one commit.
+static void show(uint16_t old_leds, uint16_t new_leds) {
+    set_leds(new_leds, old_leds ^ new_leds);
+}
+
+void ledanim_start(LedAnimPlayer *player, const LedAnim *anim) {
+    player->anim = anim;
+    player->pos = 0;
+    // Keep 'leds' as it is: the first FULL frame only rewrites what differs.
+}
+
+uint32_t ledanim_step(LedAnimPlayer *player) {
+    uint32_t start = SysTick->VAL; // Counts down at the core clock
+    const uint8_t *data = player->anim->data;
+    uint16_t pos = player->pos;
+    uint8_t header = data[pos++];
+    uint16_t leds = player->leds;
+
+    switch (header & LEDANIM_OP_MASK) {
+        case LEDANIM_OP_FULL:
+            leds = (uint16_t)(data[pos] | (data[pos + 1] << 8));
+            pos += 2;
+            break;
+        case LEDANIM_OP_XOR_GREEN:
+            leds ^= data[pos++];
+            break;
+        case LEDANIM_OP_XOR_RED:
+            leds ^= (uint16_t)(data[pos++] << 8);
+            break;
+        default: // HOLD
+            break;
+    }
+    show(player->leds, leds);
+    player->leds = leds;
+    player->pos = (pos < player->anim->size) ? pos : 0;
+
+    uint32_t end = SysTick->VAL;
+    uint32_t cycles = (start >= end) ? start - end : start + (SysTick->LOAD + 1U) - end;
+    ledanim_stats.frames++;
+    ledanim_stats.decode_cycles_last = cycles;
+    if (cycles > ledanim_stats.decode_cycles_max) {
+        ledanim_stats.decode_cycles_max = cycles;
+    }
+
+    uint32_t units = header & LEDANIM_UNITS_MASK;
+    return ((units != 0) ? units : 1U) * LEDANIM_UNIT_MS;
+}
+
+#endif // FEATURE_LEDS
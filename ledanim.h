@@ -0,0 +1,68 @@
+// ledanim.h
+#ifndef LEDANIM_H
+#define LEDANIM_H
+
+#include <stdint.h>
+
+// LED animations.
+// An animation is a loop of 16-bit LED frames kept in flash: bits 0-7 are
+// green LEDs 0-7, bits 8-15 red LEDs 0-7, 1 = lit. Frames are delta coded, so
+// a step that only changes one bank costs two bytes and a pause one byte.
+//
+// Each frame starts with a header byte: op in bits 7-6, duration in bits 5-0
+// (LEDANIM_UNIT_MS units, 1..63; 0 is read as 1).
+//   FULL       + green, red   load both banks
+//   XOR_GREEN  + bits         toggle the given green LEDs
+//   XOR_RED    + bits         toggle the given red LEDs
+//   HOLD                      keep the LEDs as they are
+// The first frame must be FULL; after the last one the animation wraps.
+// Write tables with the LEDANIM_* macros below.
+
+// --- Configuration ---
+#define LEDANIM_UNIT_MS   10
+
+#define LEDANIM_OP_FULL       0x00U
+#define LEDANIM_OP_XOR_GREEN  0x40U
+#define LEDANIM_OP_XOR_RED    0x80U
+#define LEDANIM_OP_HOLD       0xC0U
+#define LEDANIM_OP_MASK       0xC0U
+#define LEDANIM_UNITS_MASK    0x3FU
+
+#define LEDANIM_FULL(ms, green, red) (LEDANIM_OP_FULL | ((ms) / LEDANIM_UNIT_MS)), (green), (red)
+#define LEDANIM_XOR_GREEN(ms, bits)  (LEDANIM_OP_XOR_GREEN | ((ms) / LEDANIM_UNIT_MS)), (bits)
+#define LEDANIM_XOR_RED(ms, bits)    (LEDANIM_OP_XOR_RED | ((ms) / LEDANIM_UNIT_MS)), (bits)
+#define LEDANIM_HOLD(ms)             (LEDANIM_OP_HOLD | ((ms) / LEDANIM_UNIT_MS))
+
+typedef struct {
+    const char    *name;
+    const uint8_t *data;
+    uint16_t       size;      // Bytes of flash
+} LedAnim;
+
+#define LEDANIM_DEFINE(var, table) \
+    const LedAnim var = { #var, (table), sizeof(table) }
+
+typedef struct {
+    const LedAnim *anim;
+    uint16_t       pos;       // Offset of the next frame header
+    uint16_t       leds;      // Bitmap currently shown
+} LedAnimPlayer;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t decode_cycles_last;  // Core cycles to decode and show one frame
+    uint32_t decode_cycles_max;
+} LedAnimStats;
+
+extern volatile LedAnimStats ledanim_stats;
+
+// Built-in animations (ledanim.c).
+extern const LedAnim ledanim_moving;
+extern const LedAnim ledanim_stationary;
+
+// --- Function Prototypes ---
+void     ledanim_start(LedAnimPlayer *player, const LedAnim *anim);
+// Shows the next frame and returns how long it stays up, in ms.
+uint32_t ledanim_step(LedAnimPlayer *player);
+
+#endif // LEDANIM_H
@@ -0,0 +1,125 @@
+// lowpower.c
+#include "lowpower.h"
+#include "config.h"
+#include "MKL25Z4.h"
+#include "cmsis_os2.h"
+#include "sysstats.h"
+#include "timebase.h"
+#include "powermon.h"
+#include <stdbool.h>
+#include <string.h>
+
+static LowPowerAccount account;
+
+void lowpower_init(void) {
+    // Allow very-low-power modes (PMPROT is write-once after reset).
+    SMC->PMPROT = SMC_PMPROT_AVLP_MASK;
+    account.last_wake_us = timebase_now_us();
+}
+
+// After VLPS the MCG comes back in PBE mode; wait for the PLL and switch the
+// system clock back to it (PEE).
+static void restore_pll(void) {
+    while (!(MCG->S & MCG_S_LOCK0_MASK)) {}
+    MCG->C1 &= ~MCG_C1_CLKS_MASK;
+    while (((MCG->S & MCG_S_CLKST_MASK) >> MCG_S_CLKST_SHIFT) != 3) {}
+}
+
+// --- Idle Accounting ---
+PowerMode lowpower_choose_mode(uint32_t ticks) {
+    if (ticks < LOWPOWER_VLPS_MIN_TICKS) {
+        return POWER_WAIT;
+    }
+#if FEATURE_MOTOR
+    if (powermon_busy()) {
+        return POWER_WAIT;
+    }
+#endif
+#if FEATURE_LINK
+    return POWER_WAIT; // Commands must be received from the first byte on
+#else
+    return POWER_VLPS;
+#endif
+}
+
+uint32_t lowpower_sleep_begin(LowPowerAccount *a, uint32_t start_us, uint32_t ticks) {
+    a->stats.time_us[POWER_RUN] += start_us - a->last_wake_us;
+    return start_us + ticks * LOWPOWER_US_PER_TICK - a->carry_us;
+}
+
+uint32_t lowpower_sleep_end(LowPowerAccount *a, PowerMode mode, uint32_t start_us,
+                            uint32_t wake_us, uint32_t ticks) {
+    uint32_t slept = wake_us - start_us;
+    a->last_wake_us = wake_us;
+    a->stats.time_us[mode] += slept;
+    a->stats.entries[mode]++;
+
+    // Hand whole ticks back to the kernel and keep the remainder for next time
+    // so kernel time does not drift from the timebase.
+    slept += a->carry_us;
+    uint32_t elapsed_ticks = slept / LOWPOWER_US_PER_TICK;
+    if (ticks != osWaitForever && elapsed_ticks > ticks) {
+        elapsed_ticks = ticks;
+    }
+    a->carry_us = slept - elapsed_ticks * LOWPOWER_US_PER_TICK;
+    return elapsed_ticks;
+}
+
+// Sleeps for at most 'ticks' kernel ticks and returns the ticks that passed.
+static uint32_t sleep_ticks(uint32_t ticks) {
+    PowerMode mode = lowpower_choose_mode(ticks);
+    uint32_t start = timebase_now_us();
+    uint32_t wake_at = lowpower_sleep_begin(&account, start, ticks);
+
+    if (ticks != osWaitForever) {
+        timebase_set_alarm_us(wake_at);
+    }
+
+    if (mode == POWER_VLPS) {
+        SMC->PMCTRL = (SMC->PMCTRL & ~SMC_PMCTRL_STOPM_MASK) | SMC_PMCTRL_STOPM(2);
+        (void)SMC->PMCTRL; // Make sure the write lands before WFI
+        SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+    } else {
+        SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    }
+    __WFI();
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    if (mode == POWER_VLPS) {
+        restore_pll();
+    }
+    timebase_cancel_alarm();
+
+    return lowpower_sleep_end(&account, mode, start, timebase_now_us(), ticks);
+}
+
+// --- Idle Thread ---
+// Replaces the weak RTX idle thread.
+void osRtxIdleThread(void *argument) {
+    sysstats_register_idle();
+    for (;;) {
+        uint32_t ticks = osKernelSuspend(); // Ticks until the next kernel timeout
+        uint32_t elapsed = 0;
+        __disable_irq(); // Interrupts still wake WFI, and run once enabled again
+        if (ticks != 0) {
+            elapsed = sleep_ticks(ticks);
+        }
+        __enable_irq();
+        osKernelResume(elapsed);
+    }
+}
+
+// --- Readout ---
+void lowpower_get_stats(LowPowerStats *out) {
+    int32_t lock = osKernelLock();
+    *out = account.stats;
+    out->time_us[POWER_RUN] += timebase_now_us() - account.last_wake_us; // Running right now
+    osKernelRestoreLock(lock);
+}
+
+uint16_t lowpower_permille(const LowPowerStats *s, PowerMode mode) {
+    uint64_t total = s->time_us[POWER_RUN] + s->time_us[POWER_WAIT] + s->time_us[POWER_VLPS];
+    if (total == 0) {
+        return 0;
+    }
+    return (uint16_t)((s->time_us[mode] * 1000U) / total);
+}
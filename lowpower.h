@@ -0,0 +1,59 @@
+// lowpower.h
+#ifndef LOWPOWER_H
+#define LOWPOWER_H
+
+#include <stdint.h>
+
+// Tickless idle.
+// The RTX idle thread only runs when every other thread is blocked. It then
+// suspends the kernel tick and sleeps until the next kernel timeout (or any
+// interrupt), woken by a TPM2 alarm. TPM1/TPM2 run from OSCERCLK, which stays
+// on in VLPS, so the timebase, LED timing and the buzzer are not disturbed.
+//
+// Mode choice per idle period:
+//   VLPS - at least LOWPOWER_VLPS_MIN_TICKS to sleep, no motor driven (the
+//          powermon ADC scan stops with the bus clock), and no UART2 command
+//          link in the build (FEATURE_LINK). UART2 is not clocked in VLPS:
+//          the byte that woke the chip would be lost, and with it the SYNC
+//          byte of the first command after any quiet spell.
+//   WAIT - otherwise.
+
+// --- Configuration ---
+#define LOWPOWER_VLPS_MIN_TICKS 5     // Covers the PLL relock on wake-up
+#define LOWPOWER_US_PER_TICK    1000U // 1 kHz kernel tick
+
+typedef enum {
+    POWER_RUN,
+    POWER_WAIT,
+    POWER_VLPS,
+    POWER_MODES
+} PowerMode;
+
+typedef struct {
+    uint64_t time_us[POWER_MODES];  // Time spent in each mode since boot
+    uint32_t entries[POWER_MODES];  // Number of WAIT/VLPS entries
+} LowPowerStats;
+
+// Bookkeeping of the idle periods, kept apart from the sleep itself.
+typedef struct {
+    LowPowerStats stats;
+    uint32_t      last_wake_us;
+    uint32_t      carry_us;         // Sleep time not yet handed back to the kernel
+} LowPowerAccount;
+
+// --- Function Prototypes ---
+void lowpower_init(void);                                  // Call once at startup
+void lowpower_get_stats(LowPowerStats *out);
+uint16_t lowpower_permille(const LowPowerStats *stats, PowerMode mode); // Share of total time
+
+// Idle steps, in the order the idle thread runs them: the mode for a sleep of
+// 'ticks' kernel ticks; the start of the sleep at start_us, which books the
+// run time since the last wake-up and returns when to wake; and the wake-up
+// at wake_us, which books the sleep and returns the whole ticks to hand back
+// to the kernel (at most 'ticks'), carrying the rest to the next sleep.
+PowerMode lowpower_choose_mode(uint32_t ticks);
+uint32_t  lowpower_sleep_begin(LowPowerAccount *account, uint32_t start_us, uint32_t ticks);
+uint32_t  lowpower_sleep_end(LowPowerAccount *account, PowerMode mode, uint32_t start_us,
+                             uint32_t wake_us, uint32_t ticks);
+
+#endif // LOWPOWER_H
@@ -2,12 +2,60 @@
 #include "RTE_Components.h"
 #include "MKL25Z4.h"
 #include "cmsis_os2.h"
+#include "rtx_os.h"    // Control block types for static allocation
+#include "config.h"    // Build profile: which of the modules below are in
 #include <stdbool.h>
 #include "led.h"
+#include "motor.h"
 #include "audio.h" // Include the audio header
+#include "uart.h"
+#include "command.h"
+#include "telemetry.h"
+#include "sysstats.h"
+#include "mutexprof.h"
+#include "taskplan.h"
+#include "timebase.h"
+#include "lowpower.h"
+#include "board.h"
+#include "bench.h"
+#include "obstacle.h"
+#include "powermon.h"
+#include "coop.h"
+#include "envelope.h"
+#include "params.h"
 
 
 
+// --- Static Thread Memory ---
+// Control blocks and stacks are allocated here instead of from the RTX heap;
+// sizes come from taskplan.h. Stacks must be 8-byte aligned.
+#if FEATURE_LINK
+static osRtxThread_t command_tcb;
+static osRtxThread_t telemetry_tcb;
+static uint64_t command_stack[TASK_COMMAND_STACK_SIZE / 8];
+static uint64_t telemetry_stack[TASK_TELEMETRY_STACK_SIZE / 8];
+#endif
+#if FEATURE_MOTOR
+static osRtxThread_t motor_tcb;
+static uint64_t motor_stack[TASK_MOTOR_STACK_SIZE / 8];
+#endif
+#if FEATURE_STATE_DEMO
+static osRtxThread_t demo_tcb;
+static uint64_t demo_stack[TASK_STATE_DEMO_STACK_SIZE / 8];
+#endif
+#if FEATURE_COOP
+static osRtxThread_t coop_tcb;
+static uint64_t coop_stack[TASK_COOP_STACK_SIZE / 8];
+#endif
+
+static osRtxMutex_t robot_state_mutex_cb;
+static const osMutexAttr_t robot_state_mutex_attr = {
+    "robot_state",
+    osMutexPrioInherit,  // Threads now have different priorities
+    &robot_state_mutex_cb,
+    sizeof(robot_state_mutex_cb)
+};
+
 // --- Mutex Definition and Initialization (Moved to main.c) ---
 osMutexId_t robot_state_mutex;
 
@@ -15,46 +63,105 @@ osMutexId_t robot_state_mutex;
 volatile RobotState robot_state = ROBOT_STATIONARY; // Initial state
 volatile bool runComplete = false;
 
-// --- Motor Control Thread (Moved to main.c) ---
-void motor_control_thread(void *argument) {
-    // Simulate robot movement for testing
+#if FEATURE_STATE_DEMO
+// --- State Demo Thread ---
+// Stands in for the motor thread on the LED + audio bench: moves and stops
+// every 5 s, and switches the end-of-run melody after each stop.
+static void state_demo_thread(void *argument) {
     for (;;) {
-        // Move for 5 seconds
-        osMutexAcquire(robot_state_mutex, osWaitForever);
-        robot_state = ROBOT_MOVING;
-        osMutexRelease(robot_state_mutex);
-        osDelay(5000); // Simulate moving for 5 seconds
-
-        // Stop for 5 seconds
-        osMutexAcquire(robot_state_mutex, osWaitForever);
-        robot_state = ROBOT_STATIONARY;
-        osMutexRelease(robot_state_mutex);
-        osDelay(5000); // Simulate stationary for 5 seconds
-			
-			  // For testing: Toggle runComplete flag to switch melodies.
-        runComplete = !runComplete;
+        osDelay(5000);
+        MUTEX_ACQUIRE(robot_state_mutex, osWaitForever);
+        if (robot_state == ROBOT_STATIONARY) {
+            robot_state = ROBOT_MOVING;
+        } else {
+            robot_state = ROBOT_STATIONARY;
+            runComplete = !runComplete;
+        }
+        MUTEX_RELEASE(robot_state_mutex);
     }
 }
+#endif
+
+// --- Thread Creation ---
+static osThreadId_t start_task(int task, osThreadFunc_t func, void *cb_mem, void *stack_mem) {
+    osThreadAttr_t attr = {0};
+    attr.name = task_plan[task].name;
+    attr.cb_mem = cb_mem;
+    attr.cb_size = osRtxThreadCbSize;
+    attr.stack_mem = stack_mem;
+    attr.stack_size = task_plan[task].stack_size;
+    attr.priority = task_plan[task].priority;
+
+    osThreadId_t id = osThreadNew(func, NULL, &attr);
+    sysstats_register(id, task_plan[task].name);
+    return id;
+}
 
 
 // --- Main Function ---
 int main (void) {
     // System Initialization
     SystemCoreClockUpdate();
+    board_init();    // Port clocks, pin mux and GPIO directions (board.h)
+    timebase_init(); // Microsecond timebase on TPM2
+    params_init();   // Tunables from flash into RAM (params.h)
+#if FEATURE_AUDIO
+    envelope_init(); // Note envelopes stepped by TPM0
+#endif
+    lowpower_init(); // Tickless idle in WAIT/VLPS
+#if FEATURE_LEDS
     init_leds(); // Initialize LEDs
+#endif
+#if FEATURE_MOTOR
+    init_Motor();
+    powermon_init(); // Battery/motor current scan by ADC0 + DMA, stall cut
+#endif
+#if FEATURE_LINK
+    uart_init(); // Remote-control link
+#endif
+    bench_run(); // Driver timings, as JSON on UART2 with the link (BENCHMARK builds only)
 
     osKernelInitialize();
 
-    robot_state_mutex = osMutexNew(NULL); // Create the mutex here in main.c
+    // Refuse to start a task set that cannot meet its declared deadlines.
+    if (!taskplan_schedulable(task_plan, TASK_COUNT, NULL)) {
+        return -1;
+    }
+
+    robot_state_mutex = osMutexNew(&robot_state_mutex_attr); // Create the mutex here in main.c
     if (robot_state_mutex == NULL) {
         // Handle mutex creation error (e.g., print an error message)
         return -1; // Or some other error indication
     }
+    mutexprof_register(robot_state_mutex, "state");
+
+    sysstats_init(); // CPU/stack accounting, see sysstats_report
+#if FEATURE_MOTOR
+    obstacle_init(); // Ultrasonic ranging and the reflex stop
+#endif
+    params_apply();  // Stored volume, playback and reflex settings
 
-    osThreadNew(led_control_thread, NULL, NULL);
-    osThreadNew(motor_control_thread, NULL, NULL); // Create motor control thread (now defined in main.c)
-    
-		osThreadNew(audio_thread, NULL, NULL); // Create the audio thread
+#if FEATURE_AUDIO
+    audio_task_init(); // Melody sequencer, runs in the coop thread
+#endif
+#if FEATURE_LEDS
+    led_task_init();   // LED animations, runs in the coop thread
+#endif
+#if FEATURE_LINK
+    start_task(TASK_COMMAND, command_thread, &command_tcb, command_stack); // UART command decoder
+#endif
+#if FEATURE_MOTOR
+    start_task(TASK_MOTOR, motor_control_thread, &motor_tcb, motor_stack); // Motor control thread (motor.c)
+#endif
+#if FEATURE_STATE_DEMO
+    start_task(TASK_STATE_DEMO, state_demo_thread, &demo_tcb, demo_stack); // robot_state changes for the LED + audio bench
+#endif
+#if FEATURE_COOP
+    start_task(TASK_COOP, coop_thread, &coop_tcb, coop_stack); // Audio and LED tasks, EDF (coop.h)
+#endif
+#if FEATURE_LINK
+    start_task(TASK_TELEMETRY, telemetry_thread, &telemetry_tcb, telemetry_stack); // Status records over UART2 DMA
+#endif
 
     osKernelStart();
     for (;;) {}
@@ -0,0 +1,88 @@
+// melody.c
+#include "config.h"
+
+#if FEATURE_AUDIO
+
+#include "melody.h"
+#include "cmsis_os2.h"
+
+static volatile uint8_t melody_storage[MELODY_BUF_SIZE];
+static RingBuf melody_ring = RINGBUF_INIT(melody_storage);
+
+volatile MelodyStats melody_stats;
+
+static osThreadId_t player_thread = NULL;
+
+// Top octave (MIDI 120..131, C9..B9) in Hz; lower octaves are right shifts.
+static const uint16_t octave9_hz[12] = {
+    8372, 8870, 9397, 9956, 10548, 11175,
+    11840, 12544, 13290, 14080, 14917, 15804
+};
+
+// --- Producer Side ---
+// Copies len bytes of note data straight from the receive ring. All or
+// nothing, so a note never gets split across two frames.
+bool melody_write(const RingBuf *src, uint32_t offset, uint32_t len) {
+    if ((len & 1U) != 0) {
+        melody_stats.bad_frames++;
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i += 2) {
+        uint8_t note = ringbuf_peek(src, offset + i);
+        bool valid = (note >= MELODY_NOTE_MIN && note <= 127) ||
+                     note == MELODY_REST || note == MELODY_END;
+        if (!valid) {
+            melody_stats.bad_frames++;
+            return false;
+        }
+    }
+    if (ringbuf_space(&melody_ring) < len) {
+        melody_stats.rejected++;
+        return false;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        ringbuf_put(&melody_ring, ringbuf_peek(src, offset + i));
+    }
+    melody_stats.notes_queued += len / 2;
+    if (player_thread != NULL) {
+        osThreadFlagsSet(player_thread, MELODY_FLAG_DATA);
+    }
+    return true;
+}
+
+uint32_t melody_space(void) {
+    return ringbuf_space(&melody_ring);
+}
+
+// --- Consumer Side ---
+void melody_set_player(osThreadId_t thread) {
+    player_thread = thread;
+}
+
+bool melody_pending(void) {
+    return ringbuf_count(&melody_ring) >= 2;
+}
+
+bool melody_next(MelodyNote *note) {
+    if (!melody_pending()) {
+        return false;
+    }
+    note->note = ringbuf_peek(&melody_ring, 0);
+    note->units = ringbuf_peek(&melody_ring, 1);
+    if (note->units == 0) {
+        note->units = 1;
+    }
+    ringbuf_skip(&melody_ring, 2);
+    return true;
+}
+
+uint16_t melody_note_hz(uint8_t note) {
+    if (note < MELODY_NOTE_MIN || note > 127) {
+        return 0;
+    }
+    uint32_t shift = 10U - note / 12U;  // note / 12 == 10 is the table
+    uint32_t hz = octave9_hz[note % 12U];
+    return (uint16_t)((hz + (1U << shift >> 1)) >> shift); // Rounded
+}
+
+#endif // FEATURE_AUDIO
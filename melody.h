@@ -0,0 +1,64 @@
+// melody.h
+#ifndef MELODY_H
+#define MELODY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmsis_os2.h"
+#include "ringbuf.h"
+
+// Streamed melodies.
+// The host sends notes with CMD_MELODY_DATA frames; they queue up in a fixed
+// RAM ring and the audio task plays them as they come, so a song of any
+// length plays in MELODY_BUF_SIZE bytes.
+//
+// Note encoding, two bytes per note:
+//   byte 0  MIDI note number MELODY_NOTE_MIN..127 (69 = A4 = 440 Hz),
+//           MELODY_REST or MELODY_END
+//   byte 1  duration in MELODY_UNIT_MS units (1..255, 0 is read as 1)
+//
+// Backpressure: a data frame is only queued if all of it fits, otherwise it is
+// rejected whole and counted. The free space is reported in every telemetry
+// status record, so the host can send no more than that and never overruns.
+// Underrun: if the ring runs dry before MELODY_END, the buzzer goes silent
+// until the next note arrives (counted as an underrun) instead of holding the
+// last note. Timing restarts from the late note. If nothing arrives for
+// MELODY_STALL_MS the stream is dropped.
+
+// --- Configuration ---
+#define MELODY_BUF_SIZE      256     // Power of two, bytes (128 notes)
+#define MELODY_UNIT_MS       10      // Duration unit
+#define MELODY_STALL_MS      2000
+#define MELODY_NOTE_MIN      24      // C1, 33 Hz; TPM1 cannot go below ~16 Hz
+#define MELODY_REST          0x00
+#define MELODY_END           0xFF
+#define MELODY_FLAG_DATA     0x0001U // Thread flag raised on the player per frame
+
+typedef struct {
+    uint8_t  note;          // MIDI note, MELODY_REST or MELODY_END
+    uint8_t  units;         // Duration in MELODY_UNIT_MS
+} MelodyNote;
+
+typedef struct {
+    uint32_t notes_queued;
+    uint32_t notes_played;
+    uint32_t rejected;      // Frames that did not fit (host ignored the credit)
+    uint32_t bad_frames;    // Odd length or note out of range
+    uint32_t underruns;     // Ring empty while a stream was playing
+    uint32_t stalls;        // Streams dropped after MELODY_STALL_MS
+} MelodyStats;
+
+extern volatile MelodyStats melody_stats;
+
+// --- Function Prototypes ---
+// Producer side (command thread).
+bool     melody_write(const RingBuf *src, uint32_t offset, uint32_t len);
+uint32_t melody_space(void);                    // Free bytes, the host's credit
+
+// Consumer side (audio task, coop.h).
+void     melody_set_player(osThreadId_t thread); // Thread woken with MELODY_FLAG_DATA
+bool     melody_pending(void);
+bool     melody_next(MelodyNote *note);
+uint16_t melody_note_hz(uint8_t note);          // 0 for MELODY_REST
+
+#endif // MELODY_H
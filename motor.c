@@ -1,155 +1,224 @@
-// led.c
+// motor.c
+#include "config.h"
+
+#if FEATURE_MOTOR
+
 #include "motor.h" // Include the header file
 #include "RTE_Components.h" // Still needed for some definitions potentially
 #include "MKL25Z4.h" //Devide header file
 #include "cmsis_os2.h"
 #include <stdbool.h>
+#include "mutexprof.h"
+#include "deadline.h"
+#include "command.h"
+#include "timebase.h"
+#include "board.h"
+#include "wavetrace.h"
+#include "cmdtrace.h"
+#include "obstacle.h"
+#include "powermon.h"
+#include "params.h"
+#include "portout.h"
+
+#define LEFTENGINE_in BOARD_PIN_OF_MOTOR_LEFT_IN //input for four engines
+#define RIGHTENGINE_in BOARD_PIN_OF_MOTOR_RIGHT_IN
+
+#define LEFTENGINE__out BOARD_PIN_OF_MOTOR_LEFT_OUT //output for four engines
+#define RIGHTENGINE__out BOARD_PIN_OF_MOTOR_RIGHT_OUT
+
+// The driver below writes all four pins through PTC.
+typedef char motor_pins_on_port_c[(BOARD_PORT_OF_MOTOR_LEFT_IN == BOARD_PORT_C &&
+                                   BOARD_PORT_OF_MOTOR_LEFT_OUT == BOARD_PORT_C &&
+                                   BOARD_PORT_OF_MOTOR_RIGHT_IN == BOARD_PORT_C &&
+                                   BOARD_PORT_OF_MOTOR_RIGHT_OUT == BOARD_PORT_C) ? 1 : -1];
 
-#define LEFTENGINE_in 12 //input for four engines
-#define RIGHTENGINE_in 16
+#define MASK(x) (1 << (x))
+#define MOTOR_PINS (MASK(LEFTENGINE_in) | MASK(LEFTENGINE__out) | MASK(RIGHTENGINE_in) | MASK(RIGHTENGINE__out))
 
-#define LEFTENGINE__out 13 //output for four engines
-#define RIGHTENGINE__out 17
+#define MOTOR_FLAG_UPDATE   0x0001U // robot_state changed
+#define MOTOR_FLAG_OBSTACLE 0x0002U // Reflex stop from the obstacle ISR
 
-#define MASK(x) (1 << (x))
+static osThreadId_t motor_thread_id = NULL;
+static volatile uint32_t command_rx_us = 0;
 
-void initMotor() {
+void init_Motor() {
 	//if the speed is too much we probably can use a timer(PWM) to vary duty cycledx
-	SIM->SCGC5 |= SIM_SCGC5_PORTC_MASK;
+	// Pins are set up by board_init(); start with the motors off.
+	moveStop();
+}
+
 
-	PORTC->PCR[LEFTENGINE_in] &= ~PORT_PCR_MUX_MASK;
-  PORTC->PCR[LEFTENGINE_in] |= PORT_PCR_MUX(1);
-  PORTC->PCR[LEFTENGINE__out] &= ~PORT_PCR_MUX_MASK;
-  PORTC->PCR[LEFTENGINE__out] |= PORT_PCR_MUX(1);
-	
-	PORTC->PCR[RIGHTENGINE_in] &= ~PORT_PCR_MUX_MASK;
-  PORTC->PCR[RIGHTENGINE_in] |= PORT_PCR_MUX(1);
-  PORTC->PCR[RIGHTENGINE__out] &= ~PORT_PCR_MUX_MASK;
-  PORTC->PCR[RIGHTENGINE__out] |= PORT_PCR_MUX(1);
-  
-	PTC->PDDR |= MASK(LEFTENGINE_in) | MASK(RIGHTENGINE_in);
-	PTC->PDDR |= MASK(LEFTENGINE__out) | MASK(RIGHTENGINE__out);
-	
-	//turn off motors 
+// Motor pins as one 4-bit value for the waveform trace.
+static inline uint16_t motor_pins(void) {
+	uint32_t pins = PTC->PDOR;
+	return (uint16_t)(((pins & MASK(LEFTENGINE_in)) ? 8U : 0U) | ((pins & MASK(LEFTENGINE__out)) ? 4U : 0U) |
+	                  ((pins & MASK(RIGHTENGINE_in)) ? 2U : 0U) | ((pins & MASK(RIGHTENGINE__out)) ? 1U : 0U));
 }
 
+// Every move is one portout commit: the pins that go low first, then the
+// pins that go high, so no side ever drives the wrong way in between.
+static void write_pins(uint32_t mask, uint32_t levels) {
+	PortOutBatch batch = PORTOUT_BATCH_INIT;
+	portout_stage(&batch, BOARD_PORT_C, mask, levels);
+	portout_commit(&batch);
+	WAVE_SET(WAVE_MOTOR, motor_pins());
+}
 
 void moveUp() { 
 	//both sides move forward
-	PTC->PSOR = MASK(LEFTENGINE_in)| MASK(RIGHTENGINE_in);
-	PTC->PCOR = MASK(LEFTENGINE__out) | MASK(RIGHTENGINE__out);
-	osDelay(500); //move for half a second
+	write_pins(MOTOR_PINS, MASK(LEFTENGINE_in) | MASK(RIGHTENGINE_in));
 }
 
 void moveLeft() {
-	//left side move backward  
-	PTC->PSOR = MASK(LEFTENGINE__out);
-	PTC->PCOR = MASK(LEFTENGINE_in);
-	//right side move forward
-	PTC->PSOR = MASK(RIGHTENGINE_in);
-	PTC->PCOR = MASK(RIGHTENGINE__out);
-	osDelay(500); //move for half a second
+	//left side move backward, right side move forward
+	write_pins(MOTOR_PINS, MASK(LEFTENGINE__out) | MASK(RIGHTENGINE_in));
 }
 
 void moveRight() {
-	//right side move backward  
-	PTC->PSOR = MASK(RIGHTENGINE__out);
-	PTC->PCOR = MASK(RIGHTENGINE_in);
-	//left side move forward
-	PTC->PSOR = MASK(LEFTENGINE_in);
-	PTC->PCOR = MASK(LEFTENGINE__out);
-	osDelay(500); //move for half a second
+	//right side move backward, left side move forward
+	write_pins(MOTOR_PINS, MASK(RIGHTENGINE__out) | MASK(LEFTENGINE_in));
 }
 
 void moveBack() {
 	//both sides move back
-	PTC->PCOR = MASK(LEFTENGINE_in) | MASK(RIGHTENGINE_in);
-	PTC->PSOR = MASK(LEFTENGINE__out) | MASK(RIGHTENGINE__out);
-	osDelay(500); //move for half a second
+	write_pins(MOTOR_PINS, MASK(LEFTENGINE__out) | MASK(RIGHTENGINE__out));
 }
 
 void moveStop() {
 	//set both sides
-	PTC->PSOR = MASK(LEFTENGINE_in) | MASK(RIGHTENGINE_in);
-	PTC->PSOR = MASK(LEFTENGINE__out) | MASK(RIGHTENGINE__out);
+	write_pins(MOTOR_PINS, MOTOR_PINS);
+}
+
+// --- Motor Commands ---
+void motor_command(RobotState state, uint32_t rx_us) {
+    MUTEX_ACQUIRE(robot_state_mutex, osWaitForever);
+    robot_state = state;
+    command_rx_us = rx_us;
+    CMDTRACE_STATE(state, timebase_now_us());
+    // Raised with the mutex held so the thread's end-of-step check cannot miss it.
+    if (motor_thread_id != NULL) {
+        osThreadFlagsSet(motor_thread_id, MOTOR_FLAG_UPDATE);
+    }
+    MUTEX_RELEASE(robot_state_mutex);
+}
+
+static int8_t side_duty(uint32_t pins, uint32_t in_mask, uint32_t out_mask) {
+    bool in = (pins & in_mask) != 0;
+    bool out = (pins & out_mask) != 0;
+    if (in == out) {
+        return 0; // Brake (both high) or coast (both low)
+    }
+    return in ? 100 : -100;
+}
+
+void motor_get_duty(int8_t *left, int8_t *right) {
+    uint32_t pins = PTC->PDOR;
+    *left = side_duty(pins, MASK(LEFTENGINE_in), MASK(LEFTENGINE__out));
+    *right = side_duty(pins, MASK(RIGHTENGINE_in), MASK(RIGHTENGINE__out));
+}
+
+void motor_reflex_stop(void) {
+    moveStop();
+    if (motor_thread_id != NULL) {
+        osThreadFlagsSet(motor_thread_id, MOTOR_FLAG_OBSTACLE);
+    }
+}
+
+void motor_cut_side(MotorSide side) {
+    uint32_t pins = (side == MOTOR_LEFT) ? MASK(LEFTENGINE_in) | MASK(LEFTENGINE__out)
+                                         : MASK(RIGHTENGINE_in) | MASK(RIGHTENGINE__out);
+    write_pins(pins, pins);
+}
+
+static bool is_forward(RobotState state) {
+    return state == ROBOT_MOVING || state == ROBOT_MOVING_FORWARD;
+}
+
+// Step length from the parameter store: turns have their own, for turn
+// calibration.
+static uint32_t step_ms(RobotState state) {
+    bool turn = state == ROBOT_MOVING_LEFT || state == ROBOT_MOVING_RIGHT;
+    return (uint32_t)params_get(turn ? PARAM_MOTOR_TURN_MS : PARAM_MOTOR_STEP_MS);
+}
+
+static void drive(RobotState state) {
+    switch (state) {
+        case ROBOT_MOVING:
+        case ROBOT_MOVING_FORWARD:
+            moveUp();
+            break;
+        case ROBOT_MOVING_LEFT:
+            moveLeft();
+            break;
+        case ROBOT_MOVING_RIGHT:
+            moveRight();
+            break;
+        case ROBOT_MOVING_BACK:
+            moveBack();
+            break;
+        default:
+            moveStop();
+            break;
+    }
 }
 
 // --- Motor Control Thread ---
 // to test out the motor functions
-void motor_control__test_thread (void *argument) {
+void motor_control_test_thread (void *argument) {
 // Simulate robot movement for testing
-	RobotState robot_state;
+    static const RobotState sequence[] = {
+        ROBOT_MOVING_FORWARD, ROBOT_MOVING_LEFT, ROBOT_MOVING_RIGHT, ROBOT_MOVING_BACK
+    };
     for (;;) {
-        // Move forward for 5 seconds
-			  robot_state = ROBOT_MOVING_FORWARD;
-				motor_control_thread(NULL);
-        //osDelay(5000); // Simulate moving for 5 seconds
-			
-        // Stop for 5 seconds
-        robot_state = ROBOT_STATIONARY;
-				motor_control_thread(NULL);
-        osDelay(5000); 
-
-				// Move left for 5 seconds
-				robot_state = ROBOT_MOVING_LEFT;
-				motor_control_thread(NULL);
-        //osDelay(5000); // Simulate moving for 5 seconds
-			
-			  // Stop for 5 seconds
-        robot_state = ROBOT_STATIONARY;
-				motor_control_thread(NULL);
-        osDelay(5000); 
-
-				// Move right for 5 seconds
-				robot_state = ROBOT_MOVING_RIGHT;
-				motor_control_thread(NULL);
-        //osDelay(5000); // Simulate moving for 5 seconds
-			
-			  // Stop for 5 seconds
-        robot_state = ROBOT_STATIONARY;
-				motor_control_thread(NULL);
-        osDelay(5000); 
-				
-				// Move back for 5 seconds
-				robot_state = ROBOT_MOVING_BACK;
-				motor_control_thread(NULL);
-        //osDelay(5000); // Simulate moving for 5 seconds
-			
-			  // Stop for 5 seconds
-        robot_state = ROBOT_STATIONARY;
-				motor_control_thread(NULL);
-        osDelay(5000); 
+        for (int i = 0; i < 4; i++) {
+            // Move for one step, then stay stopped for 5 seconds
+            motor_command(sequence[i], timebase_now_us());
+            osDelay(MOTOR_STEP_MS + 5000);
+        }
     }
 }
 
 // --- Motor Control Thread ---
-
+// Sleeps until a command arrives, drives the pins straight away, and stops
+// again after the step time (PARAM_MOTOR_STEP_MS/PARAM_MOTOR_TURN_MS, stretched for a sagging battery, see
+// powermon_step_ms) unless a newer command has arrived by then.
 void motor_control_thread (void *argument) {
-	//actually control the movement
+	// Monitors command-to-pin latency: each command is its own job, released
+	// at the stamp of the byte that completed it and done once the pins are set.
+	int command_deadline = deadline_register("motor", MOTOR_DEADLINE_MS, 1);
+	uint32_t timeout = osWaitForever;
+	motor_thread_id = osThreadGetId();
 	for (;;) {
-        osMutexAcquire(robot_state_mutex, osWaitForever);
+        uint32_t flags = osThreadFlagsWait(MOTOR_FLAG_UPDATE | MOTOR_FLAG_OBSTACLE, osFlagsWaitAny, timeout);
+
+        MUTEX_ACQUIRE(robot_state_mutex, osWaitForever);
+        if (flags == osFlagsErrorTimeout && (osThreadFlagsGet() & MOTOR_FLAG_UPDATE) == 0) {
+            robot_state = ROBOT_STATIONARY; // Step finished without a new command
+        }
+        if (is_forward(robot_state) && obstacle_blocked()) {
+            robot_state = ROBOT_STATIONARY; // Reflex stop, or a forward command into the obstacle
+        }
         RobotState current_state = robot_state;
-		    switch (current_state) {
-					case (ROBOT_MOVING_FORWARD | ROBOT_MOVING) :
-						moveUp();
-						moveStop();
-					break;
-					case (ROBOT_MOVING_LEFT):
-						moveLeft();
-						moveStop();
-					break;
-					case (ROBOT_MOVING_RIGHT):
-						moveRight();
-						moveStop();
-					break;
-					case (ROBOT_MOVING_BACK) :
-						moveBack();
-						moveStop();
-					break;
-					default: 
-						moveStop();
-					break;
-				}
-        osMutexRelease(robot_state_mutex);
+        uint32_t rx_us = command_rx_us;
+        MUTEX_RELEASE(robot_state_mutex);
+
+        bool command = (flags & osFlagsError) == 0 && (flags & MOTOR_FLAG_UPDATE) != 0;
+        if (command) {
+            deadline_resync(command_deadline); // Sporadic: each command is its own phase
+            deadline_release_ago(command_deadline, timebase_now_us() - rx_us);
+        }
+        drive(current_state);
+        if (command) {
+            deadline_complete(command_deadline);
+            command_actuated(rx_us);
+        }
+
+        if (current_state == ROBOT_STATIONARY) {
+            timeout = osWaitForever;
+        } else {
+            timeout = powermon_step_ms(step_ms(current_state));
+        }
     }
 }
+
+#endif // FEATURE_MOTOR
@@ -2,24 +2,17 @@
 #ifndef MOTOR_H
 #define MOTOR_H
 
-#include "cmsis_os2.h" // Include for osMutexId_t and RobotState enum
-// --- Robot State --- (Keep Enum Definition in led.h - Conceptual Link to LEDs)
-typedef enum {
-    ROBOT_STATIONARY,
-		ROBOT_MOVING,
-    ROBOT_MOVING_LEFT,
-		ROBOT_MOVING_RIGHT,
-		ROBOT_MOVING_BACK,
-		ROBOT_MOVING_FORWARD
-} RobotState;
+#include <stdint.h>
+#include "cmsis_os2.h" // Include for osMutexId_t
+#include "led.h"       // RobotState enum, robot_state and robot_state_mutex
 
-// --- Mutex Declaration (Declare as extern - defined in main.c) ---
-extern osMutexId_t robot_state_mutex;
+#define MOTOR_STEP_MS 500 // Every move command drives for half a second (at POWERMON_NOMINAL_MV)
+#define MOTOR_DEADLINE_MS 2 // Command byte received -> pins written, as monitored by deadline.c
 
-// --- Robot State Variable Declaration ---  (Explicitly declare robot_state as extern)
-// This is just a declaration, not a definition and tells the compiler when
-// compiling led.c that robot_state exists somewhere else (main.c)
-extern volatile RobotState robot_state;
+typedef enum {
+    MOTOR_LEFT,
+    MOTOR_RIGHT
+} MotorSide;
 
 // --- Function Prototypes ---
 void init_Motor(void);
@@ -28,8 +21,19 @@ void moveLeft(void);
 void moveBack(void);
 void moveRight(void);
 void moveStop(void);
+// Sets robot_state and wakes the motor thread. rx_us is the timebase stamp of
+// the input that caused the command, for latency accounting.
+void motor_command(RobotState state, uint32_t rx_us);
+// Current drive per side in percent (+100 forward, -100 back, 0 stopped),
+// read back from the output pins.
+void motor_get_duty(int8_t *left, int8_t *right);
+// ISR-safe: stops both motors now and has the motor thread set
+// robot_state to ROBOT_STATIONARY (obstacle reflex).
+void motor_reflex_stop(void);
+// ISR-safe: brakes one side until the next command (stall cut).
+void motor_cut_side(MotorSide side);
 void motor_control_test_thread(void *argument);
 void motor_control_thread(void *argument);
 
 
-#endif // LED_H
+#endif // MOTOR_H
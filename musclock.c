@@ -0,0 +1,85 @@
+// musclock.c
+#include "config.h"
+
+#if FEATURE_COOP
+
+#include "musclock.h"
+#include "coop.h"
+#include "timebase.h"
+
+volatile MusClockStats musclock_stats;
+
+// Written by the audio task only. seq is odd while an update is under way,
+// so readers retry instead of taking a lock the sequencer would wait on.
+static volatile uint32_t seq = 0;
+static volatile MusClock published;
+static uint32_t beat_us = 0;
+static uint32_t beats_started = 0;
+static uint32_t next_beat_us = 0;
+
+// --- Sequencer Side ---
+void musclock_start(uint32_t beat_ms) {
+    seq++;
+    published.note = 0;
+    published.beat = 0;
+    published.playing = true;
+    seq++;
+    beat_us = ((beat_ms != 0) ? beat_ms : MUSCLOCK_STREAM_BEAT_MS) * 1000U;
+    beats_started = 0;
+    next_beat_us = timebase_now_us(); // The first note is on beat 0
+}
+
+void musclock_note(uint32_t onset_us, uint32_t duration_ms) {
+    uint32_t flags = MUSCLOCK_FLAG_NOTE;
+    // Catches up over rests and long notes; at most a few passes.
+    while ((int32_t)(onset_us - next_beat_us) >= -MUSCLOCK_BEAT_SLACK_US) {
+        beats_started++;
+        next_beat_us += beat_us;
+        flags |= MUSCLOCK_FLAG_BEAT;
+    }
+
+    seq++;
+    published.beat = beats_started - 1;
+    published.note++;
+    published.onset_us = onset_us;
+    published.duration_ms = duration_ms;
+    seq++;
+    coop_signal(flags);
+}
+
+void musclock_stop(void) {
+    seq++;
+    published.playing = false;
+    seq++;
+    coop_signal(MUSCLOCK_FLAG_STOP);
+}
+
+// --- Follower Side ---
+void musclock_read(MusClock *out) {
+    uint32_t start;
+    do {
+        start = seq;
+        out->note = published.note;
+        out->beat = published.beat;
+        out->onset_us = published.onset_us;
+        out->duration_ms = published.duration_ms;
+        out->playing = published.playing;
+    } while ((start & 1U) != 0 || start != seq);
+}
+
+bool musclock_playing(void) {
+    return published.playing;
+}
+
+void musclock_followed(void) {
+    MusClock now;
+    musclock_read(&now);
+    uint32_t skew = timebase_now_us() - now.onset_us;
+    musclock_stats.skew_last_us = skew;
+    if (skew > musclock_stats.skew_max_us) {
+        musclock_stats.skew_max_us = skew;
+    }
+    musclock_stats.followed++;
+}
+
+#endif // FEATURE_COOP
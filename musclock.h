@@ -0,0 +1,54 @@
+// musclock.h
+#ifndef MUSCLOCK_H
+#define MUSCLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Musical clock.
+// The audio sequencer publishes every note onset (rests included): note index,
+// beat index and the timebase stamp at which the buzzer changed. Followers do
+// not poll it; they are coop tasks (coop.h) and wake on the onset signal:
+//   MUSCLOCK_FLAG_NOTE  a note started
+//   MUSCLOCK_FLAG_BEAT  ... and it is the first note at or after a beat
+//   MUSCLOCK_FLAG_STOP  the melody ended
+// A beat is musclock_start()'s beat_ms; an onset up to MUSCLOCK_BEAT_SLACK_US
+// before the beat still counts as on it.
+//
+// The LED task uses it to step animations on onsets while music plays, and
+// reports the delay from each onset to the LED update as the skew.
+
+// --- Configuration ---
+#define MUSCLOCK_FLAG_NOTE       0x0100U  // Coop signals, clear of MELODY_FLAG_DATA
+#define MUSCLOCK_FLAG_BEAT       0x0200U
+#define MUSCLOCK_FLAG_STOP       0x0400U
+#define MUSCLOCK_BEAT_SLACK_US   2000
+#define MUSCLOCK_STREAM_BEAT_MS  500     // Streamed melodies carry no tempo
+
+typedef struct {
+    uint32_t note;          // Onsets since musclock_start()
+    uint32_t beat;
+    uint32_t onset_us;      // Timebase stamp of the latest onset
+    uint32_t duration_ms;   // Its length
+    bool     playing;
+} MusClock;
+
+typedef struct {
+    uint32_t followed;      // Onsets a follower reported with musclock_followed()
+    uint32_t skew_last_us;  // Onset -> follower update
+    uint32_t skew_max_us;
+} MusClockStats;
+
+extern volatile MusClockStats musclock_stats;
+
+// --- Function Prototypes ---
+// Sequencer side, audio task only.
+void musclock_start(uint32_t beat_ms);
+void musclock_note(uint32_t onset_us, uint32_t duration_ms);
+void musclock_stop(void);
+// Follower side, any thread.
+void musclock_read(MusClock *out);               // Consistent snapshot
+bool musclock_playing(void);
+void musclock_followed(void);                    // Call right after acting on an onset
+
+#endif // MUSCLOCK_H
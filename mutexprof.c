@@ -0,0 +1,189 @@
+// mutexprof.c
+#include "mutexprof.h"
+
+#ifdef MUTEX_PROFILING
+
+#include "sysstats.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+MutexProfEntry  mutexprof_mutexes[MUTEXPROF_MAX_MUTEXES];
+MutexProfThread mutexprof_threads[MUTEXPROF_MAX_THREADS];
+static uint32_t num_mutexes = 0;
+
+static MutexProfEntry *find_entry(osMutexId_t id) {
+    for (uint32_t i = 0; i < num_mutexes; i++) {
+        if (mutexprof_mutexes[i].id == id) {
+            return &mutexprof_mutexes[i];
+        }
+    }
+    return NULL;
+}
+
+// floor(log2(cycles)) shifted so that bucket 0 collects everything below 2^BUCKET0_LOG2.
+static uint32_t bucket_of(uint32_t cycles) {
+    uint32_t bucket = 0;
+    cycles >>= MUTEXPROF_BUCKET0_LOG2;
+    while (cycles != 0 && bucket < MUTEXPROF_BUCKETS - 1) {
+        cycles >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void hist_add(MutexProfHist *h, uint32_t cycles) {
+    uint32_t b = bucket_of(cycles);
+    if (h->hist[b] != UINT16_MAX) {
+        h->hist[b]++;
+    }
+    h->count++;
+    h->total_cycles += cycles;
+    if (cycles > h->max_cycles) {
+        h->max_cycles = cycles;
+    }
+}
+
+// --- Registration ---
+void mutexprof_register(osMutexId_t id, const char *name) {
+    if (id == NULL || find_entry(id) != NULL || num_mutexes >= MUTEXPROF_MAX_MUTEXES) {
+        return;
+    }
+    MutexProfEntry *e = &mutexprof_mutexes[num_mutexes];
+    memset(e, 0, sizeof(*e));
+    e->name = name;
+    e->id = id;
+    e->owner_slot = -1;
+    num_mutexes++;
+}
+
+// --- Wrappers ---
+// The wait histogram is updated after the mutex is obtained and the hold
+// histogram before it is released, so each mutex's entry is only ever written
+// by its current holder and needs no further locking. Per-thread entries are
+// only written by their own thread.
+osStatus_t mutexprof_acquire(osMutexId_t id, uint32_t timeout) {
+    MutexProfEntry *e = find_entry(id);
+    uint32_t start = osKernelGetSysTimerCount();
+
+    // Try without blocking first so contention can be counted.
+    osStatus_t status = osMutexAcquire(id, 0);
+    bool contended = (status != osOK);
+    if (contended && timeout != 0) {
+        status = osMutexAcquire(id, timeout);
+    }
+
+    uint32_t now = osKernelGetSysTimerCount();
+    if (e == NULL) {
+        return status;
+    }
+    if (status != osOK) {
+        e->timeouts++;      // Racy only against other timeouts; good enough for a counter
+        return status;
+    }
+
+    uint32_t waited = now - start;
+    int slot = sysstats_slot_of(osThreadGetId());
+    if (contended) {
+        e->contended++;
+    }
+    hist_add(&e->wait, waited);
+    if (slot >= 0 && slot < MUTEXPROF_MAX_THREADS) {
+        hist_add(&mutexprof_threads[slot].wait, waited);
+    }
+    e->owner_slot = slot;
+    e->acquired_at = now;
+    return status;
+}
+
+osStatus_t mutexprof_release(osMutexId_t id) {
+    MutexProfEntry *e = find_entry(id);
+    if (e != NULL) {
+        uint32_t held = osKernelGetSysTimerCount() - e->acquired_at;
+        hist_add(&e->hold, held);
+        if (e->owner_slot >= 0 && e->owner_slot < MUTEXPROF_MAX_THREADS) {
+            hist_add(&mutexprof_threads[e->owner_slot].hold, held);
+        }
+        e->owner_slot = -1;
+    }
+    return osMutexRelease(id);
+}
+
+void mutexprof_reset(void) {
+    for (uint32_t i = 0; i < num_mutexes; i++) {
+        memset(&mutexprof_mutexes[i].wait, 0, sizeof(MutexProfHist));
+        memset(&mutexprof_mutexes[i].hold, 0, sizeof(MutexProfHist));
+        mutexprof_mutexes[i].contended = 0;
+        mutexprof_mutexes[i].timeouts = 0;
+    }
+    memset(mutexprof_threads, 0, sizeof(mutexprof_threads));
+}
+
+// --- Report ---
+static size_t append(char *buf, size_t len, size_t pos, const char *fmt, ...) {
+    if (pos >= len - 1) {
+        return pos;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + pos, len - pos, fmt, args);
+    va_end(args);
+    if (n < 0) {
+        return pos;
+    }
+    pos += (size_t)n;
+    return (pos < len) ? pos : len - 1;
+}
+
+static uint32_t cycles_to_us(uint64_t cycles) {
+    uint32_t per_us = osKernelGetSysTimerFreq() / 1000000U;
+    return (uint32_t)(cycles / (per_us != 0 ? per_us : 1));
+}
+
+static size_t report_hist(char *buf, size_t len, size_t pos, const char *label,
+                          const char *name, const MutexProfHist *h) {
+    uint32_t avg_us = (h->count != 0) ? cycles_to_us(h->total_cycles / h->count) : 0;
+    pos = append(buf, len, pos, "%-6s %-10s n=%lu avg=%luus max=%luus |", label, name,
+                 (unsigned long)h->count, (unsigned long)avg_us,
+                 (unsigned long)cycles_to_us(h->max_cycles));
+    for (uint32_t b = 0; b < MUTEXPROF_BUCKETS; b++) {
+        if (h->hist[b] != 0) {
+            // Upper bound of the bucket in microseconds
+            uint64_t upper = (uint64_t)1 << (b + MUTEXPROF_BUCKET0_LOG2);
+            pos = append(buf, len, pos, " <%luus:%u", (unsigned long)cycles_to_us(upper), h->hist[b]);
+        }
+    }
+    return append(buf, len, pos, "\n");
+}
+
+size_t mutexprof_report(char *buf, size_t len) {
+    size_t pos = 0;
+    if (len == 0) {
+        return 0;
+    }
+    buf[0] = '\0';
+    for (uint32_t i = 0; i < num_mutexes; i++) {
+        const MutexProfEntry *e = &mutexprof_mutexes[i];
+        pos = append(buf, len, pos, "mutex %s: contended=%lu timeouts=%lu\n", e->name,
+                     (unsigned long)e->contended, (unsigned long)e->timeouts);
+        pos = report_hist(buf, len, pos, "wait", e->name, &e->wait);
+        pos = report_hist(buf, len, pos, "hold", e->name, &e->hold);
+    }
+    for (int slot = 0; slot < MUTEXPROF_MAX_THREADS; slot++) {
+        SysStatsThread t;
+        sysstats_get_thread(slot, &t);
+        if (t.name == NULL) {
+            continue;
+        }
+        if (mutexprof_threads[slot].wait.count != 0) {
+            pos = report_hist(buf, len, pos, "wait", t.name, &mutexprof_threads[slot].wait);
+        }
+        if (mutexprof_threads[slot].hold.count != 0) {
+            pos = report_hist(buf, len, pos, "hold", t.name, &mutexprof_threads[slot].hold);
+        }
+    }
+    return pos;
+}
+
+#endif // MUTEX_PROFILING
@@ -0,0 +1,71 @@
+// mutexprof.h
+#ifndef MUTEXPROF_H
+#define MUTEXPROF_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cmsis_os2.h"
+
+// Mutex contention profiler.
+// Use MUTEX_ACQUIRE/MUTEX_RELEASE instead of osMutexAcquire/osMutexRelease.
+// With MUTEX_PROFILING defined (debug target) every call records how long the
+// caller waited for the mutex and how long it then held it, as log2 histograms
+// per mutex and per thread. Without it the macros are plain RTOS calls and
+// nothing below is compiled.
+
+#ifdef MUTEX_PROFILING
+
+// --- Configuration ---
+#define MUTEXPROF_MAX_MUTEXES  4
+#define MUTEXPROF_MAX_THREADS  8   // Matches sysstats slots (SYSSTATS_MAX_THREADS)
+#define MUTEXPROF_BUCKETS      24
+#define MUTEXPROF_BUCKET0_LOG2 6   // Bucket 0: < 2^6 sys-timer cycles, bucket k: [2^(k+5), 2^(k+6))
+
+// --- Statistics ---
+typedef struct {
+    uint32_t count;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint16_t hist[MUTEXPROF_BUCKETS];   // Saturating counts
+} MutexProfHist;
+
+typedef struct {
+    const char   *name;
+    osMutexId_t   id;
+    MutexProfHist wait;
+    MutexProfHist hold;
+    uint32_t      contended;     // Acquires that found the mutex taken
+    uint32_t      timeouts;      // Acquires that did not get the mutex
+    int           owner_slot;    // sysstats slot of the current holder, -1 if none/unknown
+    uint32_t      acquired_at;   // Sys-timer count when the current holder got it
+} MutexProfEntry;
+
+typedef struct {
+    MutexProfHist wait;
+    MutexProfHist hold;
+} MutexProfThread;
+
+extern MutexProfEntry  mutexprof_mutexes[MUTEXPROF_MAX_MUTEXES];
+extern MutexProfThread mutexprof_threads[MUTEXPROF_MAX_THREADS];
+
+// --- Function Prototypes ---
+void       mutexprof_register(osMutexId_t id, const char *name);
+osStatus_t mutexprof_acquire(osMutexId_t id, uint32_t timeout);
+osStatus_t mutexprof_release(osMutexId_t id);
+void       mutexprof_reset(void);
+// Writes a text report (one line per mutex and thread, histogram in microsecond
+// buckets) into buf. Returns the number of characters written.
+size_t     mutexprof_report(char *buf, size_t len);
+
+#define MUTEX_ACQUIRE(m, timeout) mutexprof_acquire((m), (timeout))
+#define MUTEX_RELEASE(m)          mutexprof_release((m))
+
+#else // !MUTEX_PROFILING
+
+#define mutexprof_register(id, name) ((void)0)
+#define MUTEX_ACQUIRE(m, timeout)    osMutexAcquire((m), (timeout))
+#define MUTEX_RELEASE(m)             osMutexRelease((m))
+
+#endif // MUTEX_PROFILING
+
+#endif // MUTEXPROF_H
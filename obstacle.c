@@ -0,0 +1,111 @@
+// obstacle.c
+#include "config.h"
+
+#if FEATURE_MOTOR
+
+#include "obstacle.h"
+#include "MKL25Z4.h"
+#include "cmsis_os2.h"
+#include "board.h"
+#include "motor.h"
+#include "timebase.h"
+
+// Speed of sound 343 m/s, there and back: mm = us * 0.1715 = (us * 11239) >> 16.
+#define ECHO_US_TO_MM(us) (((uint32_t)(us) * 11239U) >> 16)
+
+volatile ObstacleStats obstacle_stats;
+
+static volatile uint16_t stop_mm = OBSTACLE_STOP_MM;
+static volatile ObstacleReflex reflex = OBSTACLE_REFLEX_STOP;
+static volatile uint16_t rise_us = 0;
+static volatile uint32_t rise_at_us = 0;  // Full timebase, for echoes past the 16-bit capture
+static volatile bool     echo_high = false;
+static volatile uint32_t last_reading_us = 0;
+
+// --- Capture ISR ---
+// Runs in TPM2_IRQHandler for both edges of ECHO.
+static void echo_edge(uint16_t edge_us) {
+    bool high = (BOARD_GPIO(OBSTACLE_ECHO)->PDIR & BOARD_MASK(OBSTACLE_ECHO)) != 0;
+    if (high) {
+        rise_us = edge_us;
+        rise_at_us = timebase_now_us();
+        echo_high = true;
+        return;
+    }
+    if (!echo_high) {
+        return; // Falling edge without a rising one (started mid-pulse)
+    }
+    echo_high = false;
+
+    // The capture is 16 bits: an echo held for more than 65.5 ms would alias
+    // to a short one, so the length is checked on the full timebase first.
+    last_reading_us = timebase_now_us();
+    obstacle_stats.measurements++;
+    if (last_reading_us - rise_at_us > OBSTACLE_ECHO_MAX_US) {
+        obstacle_stats.distance_mm = OBSTACLE_NO_ECHO_MM;
+        obstacle_stats.out_of_range++;
+        return;
+    }
+    uint16_t width = (uint16_t)(edge_us - rise_us);
+    uint16_t mm = (uint16_t)ECHO_US_TO_MM(width);
+    obstacle_stats.distance_mm = mm;
+
+    if (reflex == OBSTACLE_REFLEX_STOP && mm < stop_mm) {
+        int8_t left, right;
+        motor_get_duty(&left, &right);
+        if (left > 0 && right > 0) {
+            motor_reflex_stop();
+            uint16_t latency = (uint16_t)((uint16_t)timebase_now_us() - edge_us);
+            obstacle_stats.reflex_latency_last_us = latency;
+            if (latency > obstacle_stats.reflex_latency_max_us) {
+                obstacle_stats.reflex_latency_max_us = latency;
+            }
+            obstacle_stats.reflex_stops++;
+        }
+    }
+}
+
+// --- Trigger ---
+// Timer thread context. A ping is skipped while an echo is still running.
+static void ping_timer_cb(void *argument) {
+    if (echo_high) {
+        return;
+    }
+    GPIO_Type *trig = BOARD_GPIO(OBSTACLE_TRIG);
+    trig->PSOR = BOARD_MASK(OBSTACLE_TRIG);
+    timebase_delay_us(OBSTACLE_TRIG_US); // Short enough to spin
+    trig->PCOR = BOARD_MASK(OBSTACLE_TRIG);
+}
+
+void obstacle_init(void) {
+    timebase_capture_init(echo_edge);
+    osTimerId_t timer = osTimerNew(ping_timer_cb, osTimerPeriodic, NULL, NULL);
+    if (timer != NULL) {
+        osTimerStart(timer, OBSTACLE_PERIOD_MS);
+    }
+}
+
+void obstacle_set_reflex(uint16_t mm, ObstacleReflex mode) {
+    stop_mm = mm;
+    reflex = mode;
+}
+
+uint16_t obstacle_stop_mm(void) {
+    return stop_mm;
+}
+
+ObstacleReflex obstacle_reflex(void) {
+    return reflex;
+}
+
+bool obstacle_blocked(void) {
+    if (reflex == OBSTACLE_REFLEX_OFF || obstacle_stats.measurements == 0) {
+        return false;
+    }
+    if (timebase_now_us() - last_reading_us > OBSTACLE_STALE_MS * 1000U) {
+        return false; // No echo lately: sensor missing or nothing in range
+    }
+    return obstacle_stats.distance_mm < stop_mm;
+}
+
+#endif // FEATURE_MOTOR
@@ -0,0 +1,51 @@
+// obstacle.h
+#ifndef OBSTACLE_H
+#define OBSTACLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Front ultrasonic range sensor (HC-SR04 type).
+// A timer pulses TRIG (PTB3) every OBSTACLE_PERIOD_MS; the ECHO pulse (PTB2)
+// is timed in hardware by TPM2 channel 0 input capture against the
+// microsecond timebase, so ISR latency does not affect the distance.
+//
+// Reflex: when a measurement comes in below the stop distance while both
+// motors drive forward, the capture ISR stops the motors itself and then
+// tells the motor thread, which sets robot_state to ROBOT_STATIONARY. Forward
+// commands are refused while the obstacle stays in range. Turning and
+// reversing are always allowed. (The motor outputs are on/off, so "slow" is
+// not available as a reflex.)
+
+// --- Configuration ---
+#define OBSTACLE_PERIOD_MS     60     // Lets echoes of the previous ping die out
+#define OBSTACLE_STOP_MM       150    // Default reflex distance
+#define OBSTACLE_TRIG_US       10
+#define OBSTACLE_STALE_MS      (3 * OBSTACLE_PERIOD_MS) // Older readings do not block
+#define OBSTACLE_ECHO_MAX_US   25000  // About 4.3 m; longer echoes (38 ms = no object) are out of range
+#define OBSTACLE_NO_ECHO_MM    0xFFFF // distance_mm of an out-of-range reading
+
+typedef enum {
+    OBSTACLE_REFLEX_OFF,   // Measure only
+    OBSTACLE_REFLEX_STOP   // Stop in the capture ISR
+} ObstacleReflex;
+
+typedef struct {
+    uint32_t measurements;
+    uint32_t reflex_stops;
+    uint32_t out_of_range;       // Echoes longer than OBSTACLE_ECHO_MAX_US
+    uint16_t distance_mm;        // Latest reading
+    uint16_t reflex_latency_last_us; // Echo edge -> motor pins off
+    uint16_t reflex_latency_max_us;
+} ObstacleStats;
+
+extern volatile ObstacleStats obstacle_stats;
+
+// --- Function Prototypes ---
+void obstacle_init(void);       // After osKernelInitialize(); starts ranging
+void obstacle_set_reflex(uint16_t stop_mm, ObstacleReflex reflex);
+uint16_t obstacle_stop_mm(void);
+ObstacleReflex obstacle_reflex(void);
+bool obstacle_blocked(void);    // A fresh reading is below the stop distance
+
+#endif // OBSTACLE_H
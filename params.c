@@ -0,0 +1,293 @@
+// params.c
+#include "params.h"
+#include "config.h"
+#include "MKL25Z4.h"
+#include "timebase.h"
+#include "motor.h"
+#include "audio.h"
+#include "envelope.h"
+#include "fixmath.h"
+#include "obstacle.h"
+#include "powermon.h"
+
+#define PARAMS_MAGIC    0x314D5250U // "PRM1"
+#define RECORD_TAG      0xA5U       // Header bits 8-15
+#define ERASED          0xFFFFFFFFU
+
+#define FTFA_PGM4       0x06U       // Program longword
+#define FTFA_ERSSCR     0x09U       // Erase flash sector
+#define FTFA_ERRORS     (FTFA_FSTAT_ACCERR_MASK | FTFA_FSTAT_FPVIOL_MASK)
+
+// FTFA commands stall flash reads, so the launch-and-wait loop must run from
+// RAM: kl25z.sct places .ramfunc in RAM (copied at startup), and long_call
+// reaches it from flash.
+#if defined(__arm__)
+#define RAMFUNC __attribute__((section(".ramfunc"), noinline, long_call))
+#define IN_RAM(fn) ((uint32_t)(fn) >= 0x1FFFF000U) // SRAM_L start
+#else
+#define RAMFUNC
+#define IN_RAM(fn) true
+#endif
+
+volatile ParamsStats params_stats;
+
+typedef struct {
+    int32_t def;
+    int32_t min;
+    int32_t max;
+} ParamRange;
+
+static const ParamRange ranges[PARAM_COUNT] = {
+    [PARAM_MOTOR_STEP_MS]   = { MOTOR_STEP_MS, 50, 5000 },
+    [PARAM_MOTOR_TURN_MS]   = { MOTOR_STEP_MS, 50, 5000 },
+    [PARAM_NOTE_MS]         = { BUILTIN_NOTE_MS, 50, 2000 },
+    [PARAM_MELODY_RUN]      = { 0, 0, 1 },
+    [PARAM_MELODY_DONE]     = { 1, 0, 1 },
+    [PARAM_LED_SCALE]       = { 256, 64, 1024 },
+    [PARAM_VOLUME]          = { 255, 0, 255 },
+    [PARAM_TEMPO]           = { 0, -AUDIO_STEPS_MAX, AUDIO_STEPS_MAX },
+    [PARAM_TRANSPOSE]       = { 0, -AUDIO_STEPS_MAX, AUDIO_STEPS_MAX },
+    [PARAM_OBSTACLE_MM]     = { OBSTACLE_STOP_MM, 20, 4000 },
+    [PARAM_OBSTACLE_REFLEX] = { OBSTACLE_REFLEX_STOP, OBSTACLE_REFLEX_OFF, OBSTACLE_REFLEX_STOP },
+};
+
+static volatile int32_t values[PARAM_COUNT];
+static int active = -1;          // Active sector, -1 = nothing stored yet
+static uint16_t generation = 0;  // Of the active sector
+static uint32_t next_slot = 0;   // First free record slot in it
+
+// Sector layout: word 0 magic, word 1 generation (low half-word) and its
+// complement (high half-word), then the records. An erase cut short can leave
+// the magic intact and set some of the generation's bits, which would make
+// the half-erased sector the newest; the complement no longer matches then.
+static inline uint32_t sector_addr(int sector) {
+    return PARAMS_BASE + (uint32_t)sector * PARAMS_SECTOR_SIZE;
+}
+
+static inline uint32_t slot_addr(int sector, uint32_t slot) {
+    return sector_addr(sector) + 8U + slot * 8U;
+}
+
+static inline uint32_t flash_word(uint32_t addr) {
+    return *(const volatile uint32_t *)addr;
+}
+
+// --- Records ---
+// CRC-16/CCITT (0x1021, init 0xFFFF) over the key and the value, LSB first.
+static uint16_t record_crc(uint8_t key, int32_t value) {
+    uint8_t bytes[5] = { key, (uint8_t)value, (uint8_t)((uint32_t)value >> 8),
+                         (uint8_t)((uint32_t)value >> 16), (uint8_t)((uint32_t)value >> 24) };
+    uint16_t crc = 0xFFFF;
+    for (uint32_t i = 0; i < sizeof(bytes); i++) {
+        crc ^= (uint16_t)(bytes[i] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ 0x1021U) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t record_header(uint8_t key, int32_t value) {
+    return key | (RECORD_TAG << 8) | ((uint32_t)record_crc(key, value) << 16);
+}
+
+static bool in_range(uint32_t key, int32_t value) {
+    return key < PARAM_COUNT && value >= ranges[key].min && value <= ranges[key].max;
+}
+
+// --- Flash Commands ---
+RAMFUNC static uint8_t flash_launch(void) {
+    FTFA->FSTAT = FTFA_FSTAT_CCIF_MASK; // Write 1 to start
+    while ((FTFA->FSTAT & FTFA_FSTAT_CCIF_MASK) == 0) {}
+    return FTFA->FSTAT;
+}
+
+static bool flash_command(uint8_t cmd, uint32_t addr, uint32_t data) {
+    if (!IN_RAM(flash_launch)) {
+        params_stats.errors++; // Linked without kl25z.sct: it would run from flash
+        return false;
+    }
+    while ((FTFA->FSTAT & FTFA_FSTAT_CCIF_MASK) == 0) {}
+    FTFA->FSTAT = FTFA_ERRORS; // Clear errors of the previous command
+    FTFA->FCCOB0 = cmd;
+    FTFA->FCCOB1 = (uint8_t)(addr >> 16);
+    FTFA->FCCOB2 = (uint8_t)(addr >> 8);
+    FTFA->FCCOB3 = (uint8_t)addr;
+    FTFA->FCCOB4 = (uint8_t)(data >> 24);
+    FTFA->FCCOB5 = (uint8_t)(data >> 16);
+    FTFA->FCCOB6 = (uint8_t)(data >> 8);
+    FTFA->FCCOB7 = (uint8_t)data;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq(); // Vectors and handlers are in flash
+    uint8_t status = flash_launch();
+    __set_PRIMASK(primask);
+
+    if ((status & (FTFA_ERRORS | FTFA_FSTAT_MGSTAT0_MASK)) != 0) {
+        params_stats.errors++;
+        return false;
+    }
+    return true;
+}
+
+static bool program_record(uint32_t addr, uint8_t key, int32_t value) {
+    // Value first: the header commits the record.
+    return flash_command(FTFA_PGM4, addr + 4U, (uint32_t)value) &&
+           flash_command(FTFA_PGM4, addr, record_header(key, value));
+}
+
+// Writes the values that differ from their defaults, with 'value' for 'id',
+// into the next sector and makes it the active one.
+static bool compact(ParamId id, int32_t value) {
+    int target = (active < 0) ? 0 : (active + 1) % PARAMS_SECTORS;
+    uint16_t gen = (uint16_t)(generation + 1U);
+    params_stats.erases++;
+    if (!flash_command(FTFA_ERSSCR, sector_addr(target), 0)) {
+        return false;
+    }
+    uint32_t slot = 0;
+    for (uint32_t key = 0; key < PARAM_COUNT; key++) {
+        int32_t v = (key == id) ? value : values[key];
+        if (v != ranges[key].def) {
+            if (!program_record(slot_addr(target, slot), (uint8_t)key, v)) {
+                return false;
+            }
+            slot++;
+        }
+    }
+    if (!flash_command(FTFA_PGM4, sector_addr(target) + 4U, gen | ((uint32_t)(uint16_t)~gen << 16)) ||
+        !flash_command(FTFA_PGM4, sector_addr(target), PARAMS_MAGIC)) {
+        return false;
+    }
+    active = target;
+    generation = gen;
+    next_slot = slot;
+    params_stats.compactions++;
+    return true;
+}
+
+// --- Boot Load ---
+static void load_sector(int sector) {
+    uint32_t slot;
+    for (slot = 0; slot < PARAMS_RECORDS; slot++) {
+        uint32_t addr = slot_addr(sector, slot);
+        uint32_t header = flash_word(addr);
+        int32_t value = (int32_t)flash_word(addr + 4U);
+        if (header == ERASED) {
+            if ((uint32_t)value == ERASED) {
+                break; // End of the log
+            }
+            params_stats.torn++; // Value written, header not
+            continue;
+        }
+        uint8_t key = (uint8_t)header;
+        if (((header >> 8) & 0xFFU) != RECORD_TAG || (header >> 16) != record_crc(key, value)) {
+            params_stats.torn++;
+            continue;
+        }
+        if (in_range(key, value)) { // Unknown keys are from newer firmware
+            values[key] = value;
+        }
+        params_stats.records++;
+    }
+    next_slot = slot;
+}
+
+void params_init(void) {
+    uint32_t start = timebase_now_us();
+    for (uint32_t key = 0; key < PARAM_COUNT; key++) {
+        values[key] = ranges[key].def;
+    }
+    for (int sector = 0; sector < PARAMS_SECTORS; sector++) {
+        if (flash_word(sector_addr(sector)) != PARAMS_MAGIC) {
+            continue; // Erased, or a compaction that did not finish
+        }
+        uint32_t word = flash_word(sector_addr(sector) + 4U);
+        uint16_t gen = (uint16_t)word;
+        if ((uint16_t)(word >> 16) != (uint16_t)~gen) {
+            continue; // Erase cut short
+        }
+        if (active < 0 || (int16_t)(gen - generation) > 0) {
+            active = sector;
+            generation = gen;
+        }
+    }
+    if (active >= 0) {
+        load_sector(active);
+    }
+    params_stats.load_us = timebase_now_us() - start;
+}
+
+// Pushes one key into the driver that takes it by setter. The partner of a
+// setter argument keeps its live value, so a stored tempo does not undo a
+// CMD_PLAYBACK transpose.
+static void apply_key(ParamId id, int32_t value) {
+    switch (id) {
+#if FEATURE_AUDIO
+        case PARAM_VOLUME:
+            envelope_set_volume(fix_gamma8((uint8_t)value));
+            break;
+        case PARAM_TEMPO:
+            audio_set_playback((int8_t)value, audio_transpose());
+            break;
+        case PARAM_TRANSPOSE:
+            audio_set_playback(audio_tempo(), (int8_t)value);
+            break;
+#endif
+#if FEATURE_MOTOR
+        case PARAM_OBSTACLE_MM:
+            obstacle_set_reflex((uint16_t)value, obstacle_reflex());
+            break;
+        case PARAM_OBSTACLE_REFLEX:
+            obstacle_set_reflex(obstacle_stop_mm(), (ObstacleReflex)value);
+            break;
+#endif
+        default:
+            break; // Read with params_get() where it is used
+    }
+}
+
+void params_apply(void) {
+#if FEATURE_AUDIO
+    envelope_set_volume(fix_gamma8((uint8_t)values[PARAM_VOLUME]));
+    audio_set_playback((int8_t)values[PARAM_TEMPO], (int8_t)values[PARAM_TRANSPOSE]);
+#endif
+#if FEATURE_MOTOR
+    obstacle_set_reflex((uint16_t)values[PARAM_OBSTACLE_MM], (ObstacleReflex)values[PARAM_OBSTACLE_REFLEX]);
+#endif
+}
+
+int32_t params_get(ParamId id) {
+    return values[id];
+}
+
+// --- Updates ---
+bool params_set(ParamId id, int32_t value) {
+    if (!in_range(id, value)) {
+        return false;
+    }
+    if (values[id] == value) {
+        return true; // Saves a record
+    }
+    bool stored;
+    if (active < 0 || next_slot >= PARAMS_RECORDS) {
+#if FEATURE_MOTOR
+        if (powermon_busy()) {
+            params_stats.refused++; // The erase would hold off the motor interrupts
+            return false;
+        }
+#endif
+        stored = compact(id, value); // Carries the new value along
+    } else {
+        uint32_t addr = slot_addr(active, next_slot);
+        next_slot++; // Used even if programming fails
+        stored = program_record(addr, (uint8_t)id, value);
+    }
+    if (!stored) {
+        return false; // RAM keeps the value flash still holds
+    }
+    values[id] = value;
+    params_stats.writes++;
+    apply_key(id, value);
+    return true;
+}
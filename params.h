@@ -0,0 +1,81 @@
+// params.h
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Persistent tunables.
+// Calibration and tuning values are kept in a key-value log in the last
+// PARAMS_SECTORS flash sectors. params_init() copies them to RAM at boot, and
+// everything else reads the RAM copy with params_get(), so a robot is tuned
+// over the UART (CMD_PARAM) instead of by rebuilding.
+//
+// An update appends one 8-byte record: a header word (key, tag, CRC-16 of key
+// and value) and the value word. The value is programmed first and the header
+// last, so a record torn by a reset fails its CRC or has an empty header, and
+// it is skipped. For each key the newest record wins. When the sector is
+// full, the live values go to the next sector and its header (magic,
+// generation and its complement) is written last. The valid sector with the
+// highest generation is the active one, so a reset during compaction, or
+// during the erase before it, leaves the old sector in charge. Sectors are
+// used in turn, which spreads the erases.
+//
+// Boot reads at most PARAMS_RECORDS records of one sector, so it takes a
+// bounded time (params_stats.load_us).
+//
+// Flash commands stall flash reads, and the vectors and handlers are in flash,
+// so interrupts are off while one runs: about 65 us per word programmed (two
+// per update). A compaction's sector erase takes about 14 ms, which would
+// hold off the echo reflex and the power monitor's stall cut, so an update
+// that needs one is refused while a motor is driven (params_stats.refused):
+// send it again once the robot stands. UART bytes arriving during the erase
+// are lost; the host waits for the update to take effect before sending on.
+
+// --- Configuration ---
+#define PARAMS_SECTOR_SIZE  1024U
+#define PARAMS_SECTORS      2
+// The top of the 128 KB flash; kl25z.sct ends the ROM region below it.
+#define PARAMS_BASE         (0x00020000U - PARAMS_SECTORS * PARAMS_SECTOR_SIZE)
+#define PARAMS_RECORDS      ((PARAMS_SECTOR_SIZE - 8U) / 8U) // After the sector header
+
+// Keys are stored in flash: never renumber, only append.
+typedef enum {
+    PARAM_MOTOR_STEP_MS   = 0,  // Drive time of a forward/back step (MOTOR_STEP_MS)
+    PARAM_MOTOR_TURN_MS   = 1,  // Drive time of a turn step: turn calibration
+    PARAM_NOTE_MS         = 2,  // Note length of the built-in melodies
+    PARAM_MELODY_RUN      = 3,  // Built-in melody while running: 0 = melody1, 1 = melody2
+    PARAM_MELODY_DONE     = 4,  // ... once runComplete is set
+    PARAM_LED_SCALE       = 5,  // LED frame times, Q8: 256 = as authored
+    PARAM_VOLUME          = 6,  // 0..255, perceptual (as CMD_VOLUME)
+    PARAM_TEMPO           = 7,  // Steps, as audio_set_playback()
+    PARAM_TRANSPOSE       = 8,
+    PARAM_OBSTACLE_MM     = 9,  // Reflex stop distance
+    PARAM_OBSTACLE_REFLEX = 10, // ObstacleReflex
+    PARAM_COUNT
+} ParamId;
+
+typedef struct {
+    uint32_t load_us;       // params_init() time
+    uint32_t records;       // Valid records read at boot
+    uint32_t torn;          // Records skipped at boot (reset mid-write)
+    uint32_t writes;
+    uint32_t compactions;
+    uint32_t erases;
+    uint32_t errors;        // Flash commands that failed
+    uint32_t refused;       // Updates that needed an erase while the motors ran
+} ParamsStats;
+
+extern volatile ParamsStats params_stats;
+
+// --- Function Prototypes ---
+void    params_init(void);     // After timebase_init(), before any params_get()
+void    params_apply(void);    // Pushes values into the drivers that take them by setter
+int32_t params_get(ParamId id);
+// Command thread only. Stores the value, then updates the RAM copy and pushes
+// this one key into its driver; other live settings are left alone. Returns
+// false, with nothing changed, for an out-of-range value, a failed flash write
+// (counted in errors) or a refused compaction.
+bool    params_set(ParamId id, int32_t value);
+
+#endif // PARAMS_H
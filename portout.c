@@ -0,0 +1,27 @@
+// portout.c
+#include "portout.h"
+
+volatile PortOutStats portout_stats;
+
+void portout_commit(const PortOutBatch *batch) {
+    uint32_t writes = 0;
+    for (uint32_t port = 0; port < BOARD_NUM_PORTS; port++) {
+        GPIO_Type *gpio = board_gpio(port);
+        if (batch->clear[port] != 0) {
+            gpio->PCOR = batch->clear[port];
+            writes++;
+        }
+        if (batch->set[port] != 0) {
+            gpio->PSOR = batch->set[port];
+            writes++;
+        }
+    }
+
+    // Threads and ISRs commit, so the counters are updated with interrupts
+    // off; the pin writes themselves need no lock.
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    portout_stats.writes += writes;
+    portout_stats.commits++;
+    __set_PRIMASK(primask);
+}
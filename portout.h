@@ -0,0 +1,47 @@
+// portout.h
+#ifndef PORTOUT_H
+#define PORTOUT_H
+
+#include <stdint.h>
+#include "board.h"
+
+// Batched GPIO output.
+// A driver stages the output levels it wants in a PortOutBatch (a local) and
+// commits them at once: for each port one PCOR write, then one PSOR write.
+// The set/clear registers only touch the bits written, so drivers that commit
+// their own pins on a shared port (PORTC carries the motors, the green LEDs
+// and red LEDs 6-7) need no lock, and a commit from an ISR cannot undo a
+// thread's bits.
+//
+// Clears go first. A motor side that changes direction therefore passes
+// through coast (both inputs low) for the two-write gap. It never passes
+// through brake or a drive in a direction that neither the old nor the new
+// state commands, and both sides switch in the same two writes.
+
+typedef struct {
+    uint32_t set[BOARD_NUM_PORTS];
+    uint32_t clear[BOARD_NUM_PORTS];
+} PortOutBatch;
+
+#define PORTOUT_BATCH_INIT { { 0 }, { 0 } }
+
+typedef struct {
+    uint32_t commits;
+    uint32_t writes;        // PCOR/PSOR writes
+} PortOutStats;
+
+extern volatile PortOutStats portout_stats;
+
+// Pins in mask take the level of the same bit in levels; a later call for
+// the same pin wins.
+static inline void portout_stage(PortOutBatch *batch, uint32_t port, uint32_t mask, uint32_t levels) {
+    uint32_t high = mask & levels;
+    uint32_t low = mask & ~levels;
+    batch->set[port] = (batch->set[port] & ~low) | high;
+    batch->clear[port] = (batch->clear[port] & ~high) | low;
+}
+
+// --- Function Prototypes ---
+void portout_commit(const PortOutBatch *batch); // Any context
+
+#endif // PORTOUT_H
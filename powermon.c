@@ -0,0 +1,176 @@
+// powermon.c
+#include "config.h"
+
+#if FEATURE_MOTOR
+
+#include "powermon.h"
+#include "MKL25Z4.h"
+#include "fixmath.h"
+#include "motor.h"
+#include "timebase.h"
+
+#define RESULT_DMA_CH     1
+#define SC1_DMA_CH        2         // Linked from RESULT_DMA_CH, no DMAMUX source
+#define ADC0_DMA_SRC      40        // DMAMUX source: ADC0 conversion complete
+
+volatile PowerMonStats powermon_stats;
+
+// ADC channel per input, in scan order.
+static const uint8_t adc_channel[POWERMON_INPUTS] = {
+    0,   // PTE20, ADC0_SE0
+    15,  // PTC1,  ADC0_SE15
+    11   // PTC2,  ADC0_SE11
+};
+
+// SC1 word for every slot of a block. SC1_DMA_CH starts at slot 1 and its
+// last write (the extra entry) starts slot 0 of the next block, so the scan
+// keeps running while the interrupt sets up the next block.
+static uint32_t sc1_words[POWERMON_SLOTS + 1];
+static volatile uint16_t samples[2][POWERMON_SLOTS];
+static uint32_t active = 0;         // Half RESULT_DMA_CH is writing
+
+static uint32_t filter_state[POWERMON_INPUTS];
+static uint32_t stall_us[2];
+static uint32_t last_block_us = 0;
+
+// --- ADC Setup ---
+// Calibration as in the reference manual: plus-side and minus-side gain are
+// the sum of the calibration results, halved, with the MSB set.
+static void adc_calibrate(void) {
+    ADC0->SC3 = ADC_SC3_CAL_MASK | ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(3);
+    while (ADC0->SC3 & ADC_SC3_CAL_MASK) {}
+    if (ADC0->SC3 & ADC_SC3_CALF_MASK) {
+        return; // Keep the reset gains
+    }
+    uint32_t plus = ADC0->CLP0 + ADC0->CLP1 + ADC0->CLP2 + ADC0->CLP3 + ADC0->CLP4 + ADC0->CLPS;
+    ADC0->PG = (plus >> 1) | 0x8000U;
+    uint32_t minus = ADC0->CLM0 + ADC0->CLM1 + ADC0->CLM2 + ADC0->CLM3 + ADC0->CLM4 + ADC0->CLMS;
+    ADC0->MG = (minus >> 1) | 0x8000U;
+}
+
+// Points both channels at a fresh block. RESULT_DMA_CH is left with ERQ off
+// (D_REQ) after each block, so the pending ADC request waits here until the
+// linked channel is ready again.
+static void dma_arm(uint32_t half) {
+    DMA0->DMA[SC1_DMA_CH].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+    DMA0->DMA[SC1_DMA_CH].SAR = (uint32_t)&sc1_words[1];
+    DMA0->DMA[SC1_DMA_CH].DSR_BCR = DMA_DSR_BCR_BCR(POWERMON_SLOTS * sizeof(sc1_words[0]));
+
+    DMA0->DMA[RESULT_DMA_CH].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+    DMA0->DMA[RESULT_DMA_CH].DAR = (uint32_t)&samples[half][0];
+    DMA0->DMA[RESULT_DMA_CH].DSR_BCR = DMA_DSR_BCR_BCR(POWERMON_SLOTS * sizeof(samples[0][0]));
+    DMA0->DMA[RESULT_DMA_CH].DCR |= DMA_DCR_ERQ_MASK;
+}
+
+void powermon_init(void) {
+    SIM->SCGC6 |= SIM_SCGC6_ADC0_MASK | SIM_SCGC6_DMAMUX_MASK;
+    SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+
+    for (uint32_t i = 0; i <= POWERMON_SLOTS; i++) {
+        sc1_words[i] = ADC_SC1_ADCH(adc_channel[i % POWERMON_INPUTS]);
+    }
+
+    // 16-bit single-ended, long sample, ADCK = bus / 4; software trigger.
+    ADC0->CFG1 = ADC_CFG1_ADIV(2) | ADC_CFG1_ADLSMP_MASK | ADC_CFG1_MODE(3) | ADC_CFG1_ADICLK(0);
+    ADC0->SC2 = 0;
+    adc_calibrate();
+    ADC0->SC3 = ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(2); // 16 samples per result
+    ADC0->SC2 = ADC_SC2_DMAEN_MASK;
+
+    DMAMUX0->CHCFG[RESULT_DMA_CH] = 0;
+    DMAMUX0->CHCFG[RESULT_DMA_CH] = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(ADC0_DMA_SRC);
+    DMA0->DMA[RESULT_DMA_CH].SAR = (uint32_t)&ADC0->R[0];
+    DMA0->DMA[RESULT_DMA_CH].DCR = DMA_DCR_EINT_MASK | DMA_DCR_CS_MASK | DMA_DCR_SSIZE(2) |
+                                   DMA_DCR_DINC_MASK | DMA_DCR_DSIZE(2) | DMA_DCR_D_REQ_MASK |
+                                   DMA_DCR_LINKCC(2) | DMA_DCR_LCH1(SC1_DMA_CH);
+    DMA0->DMA[SC1_DMA_CH].DAR = (uint32_t)&ADC0->SC1[0];
+    DMA0->DMA[SC1_DMA_CH].DCR = DMA_DCR_CS_MASK | DMA_DCR_SINC_MASK | DMA_DCR_SSIZE(0) | DMA_DCR_DSIZE(0);
+    active = 0;
+    dma_arm(active);
+
+    NVIC_SetPriority(DMA1_IRQn, 1);
+    NVIC_ClearPendingIRQ(DMA1_IRQn);
+    NVIC_EnableIRQ(DMA1_IRQn);
+
+    last_block_us = timebase_now_us();
+    ADC0->SC1[0] = sc1_words[0]; // First conversion; DMA keeps the scan going from here
+}
+
+// --- Block Processing ---
+static uint16_t to_scale(uint16_t raw, uint32_t full_scale) {
+    return (uint16_t)(((uint32_t)raw * full_scale) >> 16);
+}
+
+static void check_stall(MotorSide side, int8_t duty, uint16_t current_ma, uint32_t block_us) {
+    if (duty == 0 || current_ma < POWERMON_STALL_MA) {
+        stall_us[side] = 0;
+        return;
+    }
+    stall_us[side] += block_us;
+    if (stall_us[side] >= POWERMON_STALL_MS * 1000U) {
+        motor_cut_side(side);
+        powermon_stats.stall_cuts[side]++;
+        stall_us[side] = 0;
+    }
+}
+
+void powermon_process_block(const volatile uint16_t *block) {
+    uint32_t sum[POWERMON_INPUTS] = {0};
+    for (uint32_t slot = 0; slot < POWERMON_SLOTS; slot += POWERMON_INPUTS) {
+        for (uint32_t in = 0; in < POWERMON_INPUTS; in++) {
+            sum[in] += block[slot + in];
+        }
+    }
+
+    uint16_t battery = powermon_filter(&filter_state[POWERMON_BATTERY],
+                                       (uint16_t)(sum[POWERMON_BATTERY] >> POWERMON_ROUNDS_SHIFT),
+                                       POWERMON_BATTERY_SHIFT);
+    uint16_t left = powermon_filter(&filter_state[POWERMON_LEFT],
+                                    (uint16_t)(sum[POWERMON_LEFT] >> POWERMON_ROUNDS_SHIFT),
+                                    POWERMON_CURRENT_SHIFT);
+    uint16_t right = powermon_filter(&filter_state[POWERMON_RIGHT],
+                                     (uint16_t)(sum[POWERMON_RIGHT] >> POWERMON_ROUNDS_SHIFT),
+                                     POWERMON_CURRENT_SHIFT);
+    powermon_stats.battery_mv = to_scale(battery, POWERMON_BATTERY_FS_MV);
+    powermon_stats.current_ma[MOTOR_LEFT] = to_scale(left, POWERMON_CURRENT_FS_MA);
+    powermon_stats.current_ma[MOTOR_RIGHT] = to_scale(right, POWERMON_CURRENT_FS_MA);
+
+    uint32_t now = timebase_now_us();
+    uint32_t block_us = now - last_block_us;
+    last_block_us = now;
+    powermon_stats.block_us = (uint16_t)block_us;
+    powermon_stats.blocks++;
+
+    int8_t duty[2];
+    motor_get_duty(&duty[MOTOR_LEFT], &duty[MOTOR_RIGHT]);
+    check_stall(MOTOR_LEFT, duty[MOTOR_LEFT], powermon_stats.current_ma[MOTOR_LEFT], block_us);
+    check_stall(MOTOR_RIGHT, duty[MOTOR_RIGHT], powermon_stats.current_ma[MOTOR_RIGHT], block_us);
+}
+
+// Once per block: hand the other half to the DMA first, then work on this one.
+void DMA1_IRQHandler(void) {
+    uint32_t done = active;
+    active ^= 1U;
+    dma_arm(active);
+    powermon_process_block(samples[done]);
+}
+
+// --- Queries ---
+uint32_t powermon_step_ms(uint32_t nominal_ms) {
+    uint16_t mv = powermon_stats.battery_mv;
+    if (mv == 0 || mv >= POWERMON_NOMINAL_MV) {
+        return nominal_ms;
+    }
+    if (mv <= POWERMON_NOMINAL_MV / 2) {
+        return 2 * nominal_ms;
+    }
+    return fix_udiv16(nominal_ms * POWERMON_NOMINAL_MV, mv);
+}
+
+bool powermon_busy(void) {
+    int8_t left, right;
+    motor_get_duty(&left, &right);
+    return left != 0 || right != 0;
+}
+
+#endif // FEATURE_MOTOR
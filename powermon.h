@@ -0,0 +1,74 @@
+// powermon.h
+#ifndef POWERMON_H
+#define POWERMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Battery and motor current monitor.
+// ADC0 scans battery (PTE20, SE0), left motor current (PTC1, SE15) and right
+// motor current (PTC2, SE11) round-robin without the CPU: DMA channel 1 moves
+// each result into one half of a two-block ring and is linked to DMA channel
+// 2, which writes the next slot's SC1 word and so starts the next conversion.
+// The CPU only runs once per block, in the DMA interrupt, where it
+//   - averages the block and runs a first-order fixed-point filter per input,
+//   - cuts a motor side whose current stays above POWERMON_STALL_MA for
+//     POWERMON_STALL_MS while it is driven, and
+//   - keeps the filtered battery voltage for motor step compensation.
+//
+// Sample time: 16 hardware averages, long sample, ADCK = bus / 4 = 6 MHz,
+// about 120 us per slot, 1.5 ms per block.
+
+// --- Configuration ---
+#define POWERMON_ROUNDS         4      // Scans of all inputs per block (power of 2)
+#define POWERMON_ROUNDS_SHIFT   2
+#define POWERMON_BATTERY_FS_MV  9900   // Battery at ADC full scale: 3.3 V behind a 1:3 divider
+#define POWERMON_CURRENT_FS_MA  6600   // Motor current at ADC full scale: 0.5 ohm shunt
+#define POWERMON_NOMINAL_MV     7200   // Battery voltage MOTOR_STEP_MS was tuned at
+#define POWERMON_STALL_MA       1500   // Above the start-up peak of a free-running motor
+#define POWERMON_STALL_MS       20     // Longer than the start-up inrush
+#define POWERMON_BATTERY_SHIFT  4      // Filter time constant, blocks (2^n)
+#define POWERMON_CURRENT_SHIFT  1
+
+typedef enum {
+    POWERMON_BATTERY,
+    POWERMON_LEFT,
+    POWERMON_RIGHT,
+    POWERMON_INPUTS
+} PowerMonInput;
+
+#define POWERMON_SLOTS (POWERMON_ROUNDS * POWERMON_INPUTS) // Results per block
+
+typedef struct {
+    uint32_t blocks;
+    uint32_t stall_cuts[2];       // Left, right
+    uint16_t battery_mv;          // Filtered
+    uint16_t current_ma[2];       // Filtered, left, right
+    uint16_t block_us;            // Time between the last two blocks
+} PowerMonStats;
+
+extern volatile PowerMonStats powermon_stats;
+
+// First-order low-pass on block means. state holds the output << 8 so small
+// steps are not lost to the shift; returns the new output.
+static inline uint16_t powermon_filter(uint32_t *state, uint16_t sample, uint32_t shift) {
+    int32_t diff = ((int32_t)sample << 8) - (int32_t)*state;
+    *state = (uint32_t)((int32_t)*state + (diff >> shift));
+    return (uint16_t)(*state >> 8);
+}
+
+// --- Function Prototypes ---
+void     powermon_init(void);      // After board_init(); calibrates ADC0 and starts the scan
+// One block of raw results in scan order (battery, left, right, repeated):
+// updates the filters and powermon_stats and runs the stall check. Called
+// from the DMA interrupt with the half the DMA has just filled.
+void     powermon_process_block(const volatile uint16_t *block);
+// MOTOR_STEP_MS scaled by nominal / filtered battery voltage, so a step
+// covers about the same distance as the battery sags. Capped at twice the
+// nominal step; the nominal step until the first block is in.
+uint32_t powermon_step_ms(uint32_t nominal_ms);
+// True while a motor side is driven: the scan needs the bus clock, so the
+// idle code must not enter VLPS then.
+bool     powermon_busy(void);
+
+#endif // POWERMON_H
@@ -0,0 +1,61 @@
+// ringbuf.h
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Lock-free single-producer/single-consumer byte ring.
+// The producer (typically an ISR) only writes 'head', the consumer only writes
+// 'tail'. Both are free-running counters; the size must be a power of two so
+// that (counter & mask) is the index and (head - tail) the fill level.
+// Consumers can look at queued bytes in place with ringbuf_peek() and drop them
+// with ringbuf_skip() once handled, so nothing is copied out.
+
+typedef struct {
+    volatile uint8_t  *data;
+    uint32_t           mask;   // size - 1
+    volatile uint32_t  head;   // Next write position (producer)
+    volatile uint32_t  tail;   // Next read position (consumer)
+} RingBuf;
+
+#define RINGBUF_INIT(storage) { (storage), sizeof(storage) - 1, 0, 0 }
+
+static inline uint32_t ringbuf_count(const RingBuf *rb) {
+    return rb->head - rb->tail;
+}
+
+static inline uint32_t ringbuf_space(const RingBuf *rb) {
+    return (rb->mask + 1) - (rb->head - rb->tail);
+}
+
+// --- Producer side ---
+static inline bool ringbuf_put(RingBuf *rb, uint8_t byte) {
+    uint32_t head = rb->head;
+    if (head - rb->tail > rb->mask) {
+        return false; // Full
+    }
+    rb->data[head & rb->mask] = byte;
+    rb->head = head + 1; // Publish only after the byte is stored
+    return true;
+}
+
+// --- Consumer side ---
+static inline uint8_t ringbuf_peek(const RingBuf *rb, uint32_t offset) {
+    return rb->data[(rb->tail + offset) & rb->mask];
+}
+
+static inline void ringbuf_skip(RingBuf *rb, uint32_t count) {
+    rb->tail += count;
+}
+
+static inline bool ringbuf_get(RingBuf *rb, uint8_t *byte) {
+    if (ringbuf_count(rb) == 0) {
+        return false;
+    }
+    *byte = ringbuf_peek(rb, 0);
+    ringbuf_skip(rb, 1);
+    return true;
+}
+
+#endif // RINGBUF_H
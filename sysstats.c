@@ -0,0 +1,172 @@
+// sysstats.c
+#include "sysstats.h"
+#include "cmsis_os2.h"
+#include <string.h>
+
+volatile SysStatsReport sysstats_report;
+
+static SysStatsThread threads[SYSSTATS_MAX_THREADS];
+static uint32_t num_threads = 0;
+
+// --- Switch-hook state (only touched inside the hook or with the kernel locked) ---
+static int      current_slot = -1;    // Slot of the running thread, -1 if unregistered
+static uint32_t last_switch  = 0;     // Sys-timer count at the last switch
+static uint64_t other_cycles = 0;     // Time spent in unregistered threads (timer thread etc.)
+static int      idle_slot    = -1;
+
+// --- Values at the previous sample, used to compute the window ---
+static uint64_t prev_cycles[SYSSTATS_MAX_THREADS];
+static uint32_t prev_switches[SYSSTATS_MAX_THREADS];
+static uint64_t prev_total = 0;
+
+static int find_slot(osThreadId_t id) {
+    for (uint32_t i = 0; i < num_threads; i++) {
+        if (threads[i].id == id) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+// --- Context-switch hook ---
+void sysstats_thread_switched(osThreadId_t next) {
+    uint32_t now = osKernelGetSysTimerCount();
+    uint32_t delta = now - last_switch; // Unsigned wrap-around keeps this correct
+    last_switch = now;
+
+    if (current_slot >= 0) {
+        threads[current_slot].cpu_cycles += delta;
+    } else {
+        other_cycles += delta;
+    }
+
+    current_slot = find_slot(next);
+    if (current_slot >= 0) {
+        threads[current_slot].switches_in++;
+    }
+}
+
+// RTX5 reports every context switch through EvrRtxThreadSwitched() when thread
+// events are compiled in (RTX_Config.h: OS_EVR_THREAD). Define
+// SYSSTATS_RTX_EVR_HOOK to take that event here instead of in the Event Recorder.
+#ifdef SYSSTATS_RTX_EVR_HOOK
+void EvrRtxThreadSwitched(osThreadId_t thread_id) {
+    sysstats_thread_switched(thread_id);
+}
+#endif
+
+// --- Registration ---
+int sysstats_register(osThreadId_t id, const char *name) {
+    if (id == NULL) {
+        return -1;
+    }
+
+    int32_t lock = osKernelLock();
+    int slot = find_slot(id);
+    if (slot < 0 && num_threads < SYSSTATS_MAX_THREADS) {
+        slot = (int)num_threads;
+        threads[slot].name = name;
+        threads[slot].id = id;
+        threads[slot].cpu_cycles = 0;
+        threads[slot].switches_in = 0;
+        threads[slot].stack_size = osThreadGetStackSize(id);
+        threads[slot].stack_min_free = threads[slot].stack_size;
+        prev_cycles[slot] = 0;
+        prev_switches[slot] = 0;
+        num_threads++;
+        // A thread registering itself is already running.
+        if (id == osThreadGetId()) {
+            current_slot = slot;
+        }
+    }
+    osKernelRestoreLock(lock);
+    return slot;
+}
+
+// Called by the idle thread itself so idle time shows up as its own slot.
+int sysstats_register_idle(void) {
+    idle_slot = sysstats_register(osThreadGetId(), "idle");
+    return idle_slot;
+}
+
+int sysstats_slot_of(osThreadId_t id) {
+    return find_slot(id);
+}
+
+// --- Sampling ---
+void sysstats_sample(void) {
+    uint64_t cycles[SYSSTATS_MAX_THREADS];
+    uint32_t switches[SYSSTATS_MAX_THREADS];
+    uint64_t total;
+    uint32_t count;
+
+    // Copy the 64-bit counters with the kernel locked so the switch hook cannot
+    // update them half-way through a read.
+    int32_t lock = osKernelLock();
+    count = num_threads;
+    total = other_cycles;
+    for (uint32_t i = 0; i < count; i++) {
+        cycles[i] = threads[i].cpu_cycles;
+        switches[i] = threads[i].switches_in;
+        total += cycles[i];
+    }
+    osKernelRestoreLock(lock);
+
+    uint32_t window = (uint32_t)(total - prev_total);
+    prev_total = total;
+
+    sysstats_report.window_cycles = window;
+    sysstats_report.num_threads = count;
+    sysstats_report.idle_permille = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t used = (uint32_t)(cycles[i] - prev_cycles[i]);
+        uint16_t permille = (window != 0) ? (uint16_t)(((uint64_t)used * 1000) / window) : 0;
+        sysstats_report.cpu_permille[i] = permille;
+        sysstats_report.switches[i] = switches[i] - prev_switches[i];
+        prev_cycles[i] = cycles[i];
+        prev_switches[i] = switches[i];
+
+        // High-water mark (needs OS_STACK_WATERMARK in RTX_Config.h).
+        uint32_t space = osThreadGetStackSpace(threads[i].id);
+        if (space < threads[i].stack_min_free) {
+            threads[i].stack_min_free = space;
+        }
+        sysstats_report.stack_min_free[i] = threads[i].stack_min_free;
+        if (threads[i].stack_min_free * 100U < threads[i].stack_size * SYSSTATS_STACK_MARGIN_PERCENT) {
+            sysstats_report.stack_low |= 1UL << i;
+        }
+
+        if ((int)i == idle_slot) {
+            sysstats_report.idle_permille = permille;
+        }
+    }
+}
+
+static void sample_timer_cb(void *argument) {
+    sysstats_sample();
+}
+
+void sysstats_init(void) {
+    last_switch = osKernelGetSysTimerCount();
+    osTimerId_t timer = osTimerNew(sample_timer_cb, osTimerPeriodic, NULL, NULL);
+    if (timer != NULL) {
+        osTimerStart(timer, SYSSTATS_SAMPLE_MS);
+    }
+}
+
+// --- Readout ---
+void sysstats_get_thread(int index, SysStatsThread *out) {
+    if (index < 0 || (uint32_t)index >= num_threads) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    int32_t lock = osKernelLock();
+    *out = threads[index];
+    osKernelRestoreLock(lock);
+}
+
+void sysstats_get_report(SysStatsReport *out) {
+    int32_t lock = osKernelLock();
+    memcpy(out, (const void *)&sysstats_report, sizeof(*out));
+    osKernelRestoreLock(lock);
+}
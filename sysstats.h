@@ -0,0 +1,54 @@
+// sysstats.h
+#ifndef SYSSTATS_H
+#define SYSSTATS_H
+
+#include <stdint.h>
+#include "cmsis_os2.h"
+
+// --- Configuration ---
+#define SYSSTATS_MAX_THREADS 8     // Registered threads, idle thread included
+#define SYSSTATS_SAMPLE_MS   1000  // Period of the snapshot in sysstats_report
+#define SYSSTATS_STACK_MARGIN_PERCENT 20  // stack_low below this much free (taskplan.h)
+
+// --- Per-thread counters (accumulated since boot) ---
+// Times are in kernel system-timer cycles (osKernelGetSysTimerFreq() per second).
+typedef struct {
+    const char   *name;
+    osThreadId_t  id;
+    uint64_t      cpu_cycles;      // Time spent running
+    uint32_t      switches_in;     // Number of times the thread was switched in
+    uint32_t      stack_size;      // Bytes
+    uint32_t      stack_min_free;  // Stack high-water mark: least free space seen (bytes)
+} SysStatsThread;
+
+// --- Periodic snapshot ---
+// Refreshed every SYSSTATS_SAMPLE_MS by a kernel timer. Values cover the last
+// window only, so add the sysstats_report symbol to a debugger watch window
+// (or read it with sysstats_get_report) to see live CPU load.
+typedef struct {
+    uint32_t window_cycles;
+    uint16_t idle_permille;                           // Idle share of the window (0..1000)
+    uint16_t cpu_permille[SYSSTATS_MAX_THREADS];      // Per registered thread
+    uint32_t switches[SYSSTATS_MAX_THREADS];          // Context switches into each thread
+    uint32_t stack_min_free[SYSSTATS_MAX_THREADS];    // Bytes
+    uint32_t stack_low;                               // Bit per slot: margin used up
+    uint32_t num_threads;
+} SysStatsReport;
+
+extern volatile SysStatsReport sysstats_report;
+
+// --- Function Prototypes ---
+void sysstats_init(void);                                   // Call after osKernelInitialize()
+int  sysstats_register(osThreadId_t id, const char *name);  // Returns slot index or -1
+int  sysstats_register_idle(void);                          // Call from the idle thread
+int  sysstats_slot_of(osThreadId_t id);                     // Slot of a registered thread or -1
+void sysstats_sample(void);                                 // Refresh sysstats_report now
+void sysstats_get_thread(int index, SysStatsThread *out);
+void sysstats_get_report(SysStatsReport *out);
+
+// Context-switch hook. Must be called by the kernel (or by the host simulation's
+// scheduler) each time 'next' is about to run. Cost: one timer read and a
+// short table lookup.
+void sysstats_thread_switched(osThreadId_t next);
+
+#endif // SYSSTATS_H
@@ -0,0 +1,64 @@
+// taskplan.c
+#include "taskplan.h"
+
+// --- Task Set ---
+// Budgets match what deadline.c monitors at run time; check its max_exec_us
+// figures before tightening one. The motor entry there is the command-to-pin
+// latency against MOTOR_DEADLINE_MS; its period here is the shortest time
+// between two drive steps.
+const TaskPlanEntry task_plan[TASK_COUNT] = {
+    //  name       priority               period   budget  critical  stack
+#if FEATURE_LINK
+    { "command", osPriorityHigh,            87,      15,      20, TASK_COMMAND_STACK_SIZE }, // woken per byte at 115200 baud
+#endif
+#if FEATURE_MOTOR
+    { "motor",   osPriorityAboveNormal,  500000,    100,      20, TASK_MOTOR_STACK_SIZE   }, // 500 ms drive step
+#endif
+#if FEATURE_STATE_DEMO
+    { "demo",    osPriorityAboveNormal, 5000000,     20,      10, TASK_STATE_DEMO_STACK_SIZE }, // robot_state every 5 s
+#endif
+#if FEATURE_COOP
+    { "coop",    osPriorityNormal,        10000,   1500,      20, TASK_COOP_STACK_SIZE    }, // LED frame (10 ms); a note and a frame per job, no spinning (coop_thread)
+#endif
+#if FEATURE_LINK
+    { "telem",   osPriorityLow,          100000,    300,      20, TASK_TELEMETRY_STACK_SIZE }, // TELEMETRY_PERIOD_MS
+#endif
+};
+
+// --- Response-Time Analysis ---
+// R = B + C + sum over higher-priority j of ceil(R / T_j) * C_j, iterated to a
+// fixed point. B is the longest critical section of any lower-priority task.
+bool taskplan_schedulable(const TaskPlanEntry *plan, uint32_t count, uint32_t *response_us) {
+    bool ok = true;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t blocking = 0;
+        for (uint32_t j = 0; j < count; j++) {
+            if (plan[j].priority < plan[i].priority && plan[j].critical_us > blocking) {
+                blocking = plan[j].critical_us;
+            }
+        }
+
+        uint32_t response = blocking + plan[i].budget_us;
+        uint32_t previous = 0;
+        while (response != previous && response <= plan[i].period_us) {
+            previous = response;
+            response = blocking + plan[i].budget_us;
+            for (uint32_t j = 0; j < count; j++) {
+                // Equal priorities share the CPU round-robin, so count them as interference too.
+                if (j != i && plan[j].priority >= plan[i].priority) {
+                    uint32_t releases = (previous + plan[j].period_us - 1) / plan[j].period_us;
+                    response += releases * plan[j].budget_us;
+                }
+            }
+        }
+
+        if (response_us != NULL) {
+            response_us[i] = response;
+        }
+        if (response > plan[i].period_us) {
+            ok = false;
+        }
+    }
+    return ok;
+}
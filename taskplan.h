@@ -0,0 +1,77 @@
+// taskplan.h
+#ifndef TASKPLAN_H
+#define TASKPLAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmsis_os2.h"
+#include "config.h"
+
+// --- Task Set ---
+// Fixed priorities: command decoder > motor > coop runtime, so a received
+// command reaches the pins first. Audio sequencing and the LEDs share the coop
+// thread (coop.h), where note onsets win over LED frames by earlier deadline.
+// Telemetry only uses leftover time. taskplan_schedulable() checks the
+// plan with these priorities rather than assuming a rate-monotonic order.
+// Only the threads of the build profile (config.h) are in the plan.
+enum {
+#if FEATURE_LINK
+    TASK_COMMAND,
+#endif
+#if FEATURE_MOTOR
+    TASK_MOTOR,
+#endif
+#if FEATURE_STATE_DEMO
+    TASK_STATE_DEMO,
+#endif
+#if FEATURE_COOP
+    TASK_COOP,
+#endif
+#if FEATURE_LINK
+    TASK_TELEMETRY,
+#endif
+    TASK_COUNT
+};
+
+// --- Stack Sizes (bytes, multiple of 8) ---
+// Deepest call path of the thread, plus 96 bytes for the exception frame, the
+// registers RTX saves on a switch and the RTOS call wrappers, plus 25% margin
+// (20% of the size free), rounded up to 8. The paths are static figures from
+// gcc -fstack-usage -fcallgraph-info=su at -Os with 32-bit frames, the coop
+// tasks' calls resolved by hand; they are not yet board measurements.
+// sysstats_report.stack_low flags a thread whose high-water mark ate into the
+// margin. Once a course has run, replace a path with the measured
+// stack_size - stack_min_free less 96, and redo this whenever a call tree
+// changes.
+//   thread     path  size  deepest call
+//   command     256   440  command_poll > params_set > flash_command
+//   motor       180   352  moveLeft > write_pins > portout_commit
+//   coop        336   544  led_task_run > ledanim_step > set_leds > portout_commit
+//   telemetry   400   624  272-byte frame (record[]) > lowpower_get_stats
+//   demo         32   160  osDelay, robot_state_mutex
+#define TASK_COMMAND_STACK_SIZE 440
+#define TASK_MOTOR_STACK_SIZE 352
+#define TASK_COOP_STACK_SIZE  544
+#define TASK_TELEMETRY_STACK_SIZE 624
+#define TASK_STATE_DEMO_STACK_SIZE 160
+
+typedef struct {
+    const char   *name;
+    osPriority_t  priority;
+    uint32_t      period_us;     // Minimum time between job releases (deadline = period)
+    uint32_t      budget_us;     // Worst-case execution time per job
+    uint32_t      critical_us;   // Longest time a job holds robot_state_mutex
+    uint32_t      stack_size;
+} TaskPlanEntry;
+
+extern const TaskPlanEntry task_plan[TASK_COUNT];
+
+// --- Function Prototypes ---
+// Fixed-priority response-time analysis (deadline = period, blocking from
+// lower-priority critical sections under priority inheritance). Writes each
+// task's worst-case response time to response_us (may be NULL) and returns
+// true if every task meets its deadline. Pure C, so the same check runs on the
+// host against the same table.
+bool taskplan_schedulable(const TaskPlanEntry *plan, uint32_t count, uint32_t *response_us);
+
+#endif // TASKPLAN_H
@@ -0,0 +1,123 @@
+// telemetry.c
+#include "config.h"
+
+#if FEATURE_LINK
+
+#include "telemetry.h"
+#include "cmsis_os2.h"
+#include "motor.h"
+#include "audio.h"
+#include "uart.h"
+#include "command.h"
+#include "cobs.h"
+#include "sysstats.h"
+#include "timebase.h"
+#include "mutexprof.h"
+#include "lowpower.h"
+#include "melody.h"
+#include "powermon.h"
+
+#define RECORD_MAX_BYTES (34 + 2 * SYSSTATS_MAX_THREADS)
+
+volatile TelemetryStats telemetry_stats;
+
+// Owned by the DMA while a packet is in flight.
+static uint8_t tx_packet[COBS_MAX_ENCODED(RECORD_MAX_BYTES) + 1];
+
+// --- Record Packing ---
+static uint32_t put_u8(uint8_t *buf, uint32_t pos, uint8_t value) {
+    buf[pos] = value;
+    return pos + 1;
+}
+
+static uint32_t put_u16(uint8_t *buf, uint32_t pos, uint16_t value) {
+    buf[pos] = (uint8_t)value;
+    buf[pos + 1] = (uint8_t)(value >> 8);
+    return pos + 2;
+}
+
+static uint32_t put_u32(uint8_t *buf, uint32_t pos, uint32_t value) {
+    pos = put_u16(buf, pos, (uint16_t)value);
+    return put_u16(buf, pos, (uint16_t)(value >> 16));
+}
+
+static uint32_t pack_status(uint8_t *buf, uint8_t seq) {
+    SysStatsReport report;
+    LowPowerStats power;
+    int8_t left = 0, right = 0;
+    uint32_t pos = 0;
+
+    MUTEX_ACQUIRE(robot_state_mutex, osWaitForever);
+    RobotState state = robot_state;
+    MUTEX_RELEASE(robot_state_mutex);
+#if FEATURE_MOTOR
+    motor_get_duty(&left, &right);
+#endif
+    sysstats_get_report(&report);
+    lowpower_get_stats(&power);
+
+    pos = put_u8(buf, pos, TELEMETRY_TYPE_STATUS);
+    pos = put_u8(buf, pos, seq);
+    pos = put_u32(buf, pos, timebase_now_us());
+    pos = put_u8(buf, pos, (uint8_t)state);
+    pos = put_u8(buf, pos, (uint8_t)left);
+    pos = put_u8(buf, pos, (uint8_t)right);
+#if FEATURE_AUDIO
+    pos = put_u16(buf, pos, audio_note_hz);
+#else
+    pos = put_u16(buf, pos, 0);
+#endif
+    pos = put_u16(buf, pos, report.idle_permille);
+    pos = put_u16(buf, pos, lowpower_permille(&power, POWER_WAIT));
+    pos = put_u16(buf, pos, lowpower_permille(&power, POWER_VLPS));
+    pos = put_u32(buf, pos, command_stats.latency_last_us);
+    pos = put_u32(buf, pos, command_stats.latency_max_us);
+#if FEATURE_AUDIO
+    pos = put_u16(buf, pos, (uint16_t)melody_space());
+#else
+    pos = put_u16(buf, pos, 0);
+#endif
+#if FEATURE_MOTOR
+    pos = put_u16(buf, pos, powermon_stats.battery_mv);
+    pos = put_u16(buf, pos, powermon_stats.current_ma[MOTOR_LEFT]);
+    pos = put_u16(buf, pos, powermon_stats.current_ma[MOTOR_RIGHT]);
+#else
+    for (int i = 0; i < 3; i++) {
+        pos = put_u16(buf, pos, 0); // Same record layout in every profile
+    }
+#endif
+    pos = put_u8(buf, pos, (uint8_t)report.num_threads);
+    for (uint32_t i = 0; i < report.num_threads; i++) {
+        pos = put_u16(buf, pos, report.cpu_permille[i]);
+    }
+    return pos;
+}
+
+// --- Telemetry Thread ---
+// Lowest-priority thread: it only runs when the control threads are idle, and
+// osDelayUntil keeps the packet rate fixed however late it gets the CPU.
+void telemetry_thread(void *argument) {
+    uint8_t record[RECORD_MAX_BYTES];
+    uint8_t seq = 0;
+    uint32_t next = osKernelGetTickCount();
+
+    for (;;) {
+        next += TELEMETRY_PERIOD_MS;
+        osDelayUntil(next);
+
+        if (uart_tx_busy()) {
+            telemetry_stats.dropped++;
+            continue;
+        }
+        uint32_t len = pack_status(record, seq++);
+        uint32_t encoded = cobs_encode(record, len, tx_packet);
+        tx_packet[encoded++] = 0x00; // Frame delimiter
+        if (uart_tx_dma(tx_packet, encoded)) {
+            telemetry_stats.sent++;
+        } else {
+            telemetry_stats.dropped++; // Another thread took the link since the check
+        }
+    }
+}
+
+#endif // FEATURE_LINK
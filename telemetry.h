@@ -0,0 +1,49 @@
+// telemetry.h
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// Binary telemetry on the UART2 transmit line.
+// Every TELEMETRY_PERIOD_MS a status record is packed, COBS encoded, terminated
+// with 0x00 and handed to the DMA in one go. If the previous packet is still
+// being sent the new one is dropped rather than waited for.
+//
+// Status record (little-endian):
+//   off size  field
+//    0   1    type = TELEMETRY_TYPE_STATUS
+//    1   1    sequence number (wraps)
+//    2   4    timebase, us
+//    6   1    robot_state (RobotState)
+//    7   1    left motor duty, int8 percent
+//    8   1    right motor duty, int8 percent
+//    9   2    buzzer frequency, Hz (0 = silent)
+//   11   2    idle, permille of the last sysstats window
+//   13   2    time in WAIT since boot, permille
+//   15   2    time in VLPS since boot, permille
+//   17   4    command latency, last, us
+//   21   4    command latency, max, us
+//   25   2    melody ring free bytes (credit for CMD_MELODY_DATA)
+//   27   2    battery, mV (filtered, see powermon.h)
+//   29   2    left motor current, mA
+//   31   2    right motor current, mA
+//   33   1    n = number of threads
+//   34   2*n  CPU permille per sysstats thread slot
+
+// --- Configuration ---
+#define TELEMETRY_PERIOD_MS   100
+#define TELEMETRY_TYPE_STATUS 0x01
+#define TELEMETRY_TYPE_CMDTRACE 0x02  // Session dump chunk, see cmdtrace.h
+#define TELEMETRY_TYPE_WAVETRACE 0x03 // VCD dump chunk, see wavetrace.h
+
+typedef struct {
+    uint32_t sent;
+    uint32_t dropped;   // Link busy with the previous packet or another sender
+} TelemetryStats;
+
+extern volatile TelemetryStats telemetry_stats;
+
+// --- Function Prototypes ---
+void telemetry_thread(void *argument);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,225 @@
+// MKL25Z4.h (host stub)
+// The KL25Z registers and intrinsics the firmware uses, for the host tests.
+// Peripherals are plain structs (test/stubs/stubs.c); nothing has side effects.
+#ifndef MKL25Z4_H_
+#define MKL25Z4_H_
+#include <stdint.h>
+#define __I volatile const
+#define __O volatile
+#define __IO volatile
+typedef enum { UART0_IRQn=12, UART1_IRQn=13, UART2_IRQn=14, ADC0_IRQn=15, TPM0_IRQn=17, TPM1_IRQn=18, TPM2_IRQn=19, LPTMR0_IRQn=28, PIT_IRQn=22, DMA0_IRQn=0, DMA1_IRQn=1, DMA2_IRQn=2, DMA3_IRQn=3, FTFA_IRQn=5, SysTick_IRQn=-1 } IRQn_Type;
+void NVIC_EnableIRQ(IRQn_Type); void NVIC_DisableIRQ(IRQn_Type); void NVIC_SetPriority(IRQn_Type, uint32_t); void NVIC_ClearPendingIRQ(IRQn_Type); void NVIC_SetPendingIRQ(IRQn_Type); uint32_t NVIC_GetPendingIRQ(IRQn_Type);
+uint32_t __get_IPSR(void); void __disable_irq(void); void __enable_irq(void); uint32_t __get_PRIMASK(void); void __set_PRIMASK(uint32_t); void __WFI(void); void __DSB(void); void __ISB(void); void __NOP(void);
+extern uint32_t SystemCoreClock; void SystemCoreClockUpdate(void);
+typedef struct { __IO uint32_t SOPT1, SOPT1CFG, SOPT2, SOPT4, SOPT5, SOPT7, SDID, SCGC4, SCGC5, SCGC6, SCGC7, CLKDIV1, FCFG1, FCFG2, UIDMH, UIDML, UIDL, COPC, SRVCOP; } SIM_Type;
+#ifdef PORT_ACCESS_LOG
+// Every PCR, GPCLR or GPCHR access calls port_access() (defined by the test),
+// which counts it. It returns 0 for a PCR, so those hit PCR_[0][n], and the
+// running write number for GPCLR/GPCHR, so a port's global pin control
+// writes stay in its log in order.
+#define PORT_LOG_SIZE 32
+typedef struct { __IO uint32_t PCR_[1][32]; __O uint32_t GPCLR_[PORT_LOG_SIZE], GPCHR_[PORT_LOG_SIZE]; __IO uint32_t ISFR; } PORT_Type;
+uint32_t port_access(int global);
+#define PCR   PCR_[port_access(0)]
+#define GPCLR GPCLR_[port_access(1)]
+#define GPCHR GPCHR_[port_access(1)]
+#else
+typedef struct { __IO uint32_t PCR[32]; __O uint32_t GPCLR, GPCHR; __IO uint32_t ISFR; } PORT_Type;
+#endif
+typedef struct { __IO uint32_t PDOR; __O uint32_t PSOR, PCOR, PTOR; __I uint32_t PDIR; __IO uint32_t PDDR; } GPIO_Type;
+typedef struct { __IO uint32_t CnSC, CnV; } TPM_CONTROLS_Type;
+typedef struct { __IO uint32_t SC, CNT, MOD; TPM_CONTROLS_Type CONTROLS[6]; __IO uint32_t STATUS, CONF; } TPM_Type;
+typedef struct { __IO uint32_t CSR, PSR, CMR, CNR; } LPTMR_Type;
+typedef struct { __IO uint32_t CTRL, LOAD, VAL, CALIB; } SysTick_Type;
+typedef struct { __IO uint32_t CPUID, ICSR, VTOR, AIRCR, SCR, CCR; } SCB_Type;
+typedef struct { __IO uint8_t PMPROT, PMCTRL, STOPCTRL, PMSTAT; } SMC_Type;
+typedef struct { __IO uint8_t C1, C2, C3, C4, C5, C6, S, SC, ATCVH, ATCVL, C7, C8, C9, C10; } MCG_Type;
+typedef struct { __IO uint8_t CR; } OSC_Type;
+typedef struct { __IO uint8_t BDH, BDL, C1, C2; __I uint8_t S1; __IO uint8_t S2, C3, D, C4; } UART_Type;
+typedef struct { __IO uint32_t SAR, DAR, DSR_BCR, DCR; } DMA_CH_Type;
+typedef struct { DMA_CH_Type DMA[4]; } DMA_Type;
+typedef struct { __IO uint8_t CHCFG[4]; } DMAMUX_Type;
+typedef struct { __IO uint32_t SC1[2], CFG1, CFG2; __I uint32_t R[2]; __IO uint32_t CV1, CV2, SC2, SC3, OFS, PG, MG, CLPD, CLPS, CLP4, CLP3, CLP2, CLP1, CLP0; uint32_t RESERVED_0; __IO uint32_t CLMD, CLMS, CLM4, CLM3, CLM2, CLM1, CLM0; } ADC_Type;
+typedef struct { __IO uint32_t MCR; uint32_t r[63]; struct { __IO uint32_t LDVAL; __I uint32_t CVAL; __IO uint32_t TCTRL, TFLG; } CHANNEL[2]; } PIT_Type;
+#ifdef FTFA_ACCESS_HOOK
+// Every FSTAT access calls ftfa_access() (defined by the test) first, which
+// sees what was written since and runs the command a CCIF write launched.
+// The slot is 32 bits wide so the test can keep a marker above the 8 flag
+// bits and tell a write from an unchanged value.
+typedef struct { __IO uint32_t FSTAT_[1]; __IO uint8_t FCNFG, FSEC, FOPT, FCCOB3, FCCOB2, FCCOB1, FCCOB0, FCCOB7, FCCOB6, FCCOB5, FCCOB4, FCCOBB, FCCOBA, FCCOB9, FCCOB8; } FTFA_Type;
+uint32_t ftfa_access(void);
+#define FSTAT FSTAT_[ftfa_access()]
+#else
+typedef struct { __IO uint8_t FSTAT, FCNFG, FSEC, FOPT, FCCOB3, FCCOB2, FCCOB1, FCCOB0, FCCOB7, FCCOB6, FCCOB5, FCCOB4, FCCOBB, FCCOBA, FCCOB9, FCCOB8; } FTFA_Type;
+#endif
+extern SIM_Type SIM_s; extern PORT_Type PORTA_s, PORTB_s, PORTC_s, PORTD_s, PORTE_s; extern GPIO_Type PTA_s, PTB_s, PTC_s, PTD_s, PTE_s;
+extern TPM_Type TPM0_s, TPM1_s, TPM2_s; extern LPTMR_Type LPTMR0_s; extern SysTick_Type SysTick_s; extern SCB_Type SCB_s; extern SMC_Type SMC_s; extern MCG_Type MCG_s; extern OSC_Type OSC0_s;
+extern UART_Type UART1_s, UART2_s; extern DMA_Type DMA0_s; extern DMAMUX_Type DMAMUX0_s; extern ADC_Type ADC0_s; extern PIT_Type PIT_s; extern FTFA_Type FTFA_s;
+#define SIM (&SIM_s)
+#define PORTA (&PORTA_s)
+#define PORTB (&PORTB_s)
+#define PORTC (&PORTC_s)
+#define PORTD (&PORTD_s)
+#define PORTE (&PORTE_s)
+#define PTA (&PTA_s)
+#define PTB (&PTB_s)
+#define PTC (&PTC_s)
+#define PTD (&PTD_s)
+#define PTE (&PTE_s)
+#define TPM0 (&TPM0_s)
+#define TPM1 (&TPM1_s)
+#define TPM2 (&TPM2_s)
+#define LPTMR0 (&LPTMR0_s)
+#define SysTick (&SysTick_s)
+#define SCB (&SCB_s)
+#define SMC (&SMC_s)
+#define MCG (&MCG_s)
+#define OSC0 (&OSC0_s)
+#define UART1 (&UART1_s)
+#define UART2 (&UART2_s)
+#define DMA0 (&DMA0_s)
+#define DMAMUX0 (&DMAMUX0_s)
+#define ADC0 (&ADC0_s)
+#define PIT (&PIT_s)
+#define FTFA (&FTFA_s)
+#define SIM_SCGC5 (SIM->SCGC5)
+#define TPM1_C0V (TPM1->CONTROLS[0].CnV)
+#define TPM1_C0SC (TPM1->CONTROLS[0].CnSC)
+#define TPM2_C0V (TPM2->CONTROLS[0].CnV)
+#define TPM2_C0SC (TPM2->CONTROLS[0].CnSC)
+#define SIM_SCGC5_PORTA_MASK 0x200u
+#define SIM_SCGC5_PORTB_MASK 0x400u
+#define SIM_SCGC5_PORTC_MASK 0x800u
+#define SIM_SCGC5_PORTD_MASK 0x1000u
+#define SIM_SCGC5_PORTE_MASK 0x2000u
+#define SIM_SCGC5_LPTMR_MASK 0x1u
+#define SIM_SCGC6_TPM0_MASK 0x1000000u
+#define SIM_SCGC6_TPM1_MASK 0x2000000u
+#define SIM_SCGC6_TPM2_MASK 0x4000000u
+#define SIM_SCGC6_ADC0_MASK 0x8000000u
+#define SIM_SCGC6_PIT_MASK 0x800000u
+#define SIM_SCGC6_DMAMUX_MASK 0x2u
+#define SIM_SCGC6_FTF_MASK 0x1u
+#define SIM_SCGC7_DMA_MASK 0x100u
+#define SIM_SCGC4_UART1_MASK 0x800u
+#define SIM_SCGC4_UART2_MASK 0x1000u
+#define SIM_SOPT2_TPMSRC_MASK 0x3000000u
+#define SIM_SOPT2_TPMSRC(x) (((uint32_t)(x))<<24)
+#define PORT_PCR_MUX_MASK 0x700u
+#define PORT_PCR_MUX(x) (((uint32_t)(x))<<8)
+#define PORT_PCR_ISF_MASK 0x1000000u
+#define PORT_PCR_IRQC(x) (((uint32_t)(x))<<16)
+#define PORT_PCR_IRQC_MASK 0xF0000u
+#define PORT_GPCLR_GPWE(x) (((uint32_t)(x))<<16)
+#define PORT_GPCLR_GPWD(x) ((uint32_t)(x))
+#define PORT_GPCHR_GPWE(x) (((uint32_t)(x))<<16)
+#define PORT_GPCHR_GPWD(x) ((uint32_t)(x))
+#define TPM_SC_CMOD_MASK 0x18u
+#define TPM_SC_CMOD(x) (((uint32_t)(x))<<3)
+#define TPM_SC_PS_MASK 0x7u
+#define TPM_SC_PS(x) ((uint32_t)(x))
+#define TPM_SC_CPWMS_MASK 0x20u
+#define TPM_SC_TOIE_MASK 0x40u
+#define TPM_SC_TOF_MASK 0x80u
+#define TPM_CnSC_ELSA_MASK 0x4u
+#define TPM_CnSC_ELSB_MASK 0x8u
+#define TPM_CnSC_MSA_MASK 0x10u
+#define TPM_CnSC_MSB_MASK 0x20u
+#define TPM_CnSC_CHIE_MASK 0x40u
+#define TPM_CnSC_CHF_MASK 0x80u
+#define TPM_CnSC_ELSA(x) (((uint32_t)(x))<<2)
+#define TPM_CnSC_ELSB(x) (((uint32_t)(x))<<3)
+#define TPM_CnSC_MSA(x) (((uint32_t)(x))<<4)
+#define TPM_CnSC_MSB(x) (((uint32_t)(x))<<5)
+#define TPM_CONF_DBGMODE(x) (((uint32_t)(x))<<6)
+#define TPM_CONF_DBGMODE_MASK 0xC0u
+#define LPTMR_CSR_TEN_MASK 0x1u
+#define LPTMR_CSR_TIE_MASK 0x40u
+#define LPTMR_CSR_TCF_MASK 0x80u
+#define LPTMR_PSR_PCS(x) ((uint32_t)(x))
+#define LPTMR_PSR_PBYP_MASK 0x4u
+#define LPTMR_PSR_PRESCALE(x) (((uint32_t)(x))<<3)
+#define SysTick_CTRL_ENABLE_Msk 1u
+#define SysTick_CTRL_TICKINT_Msk 2u
+#define SCB_SCR_SLEEPDEEP_Msk 4u
+#define SMC_PMPROT_AVLP_MASK 0x20u
+#define SMC_PMCTRL_STOPM_MASK 0x7u
+#define SMC_PMCTRL_STOPM(x) ((uint8_t)(x))
+#define MCG_S_LOCK0_MASK 0x40u
+#define MCG_S_CLKST_MASK 0xCu
+#define MCG_S_CLKST_SHIFT 2
+#define MCG_S_PLLST_MASK 0x20u
+#define MCG_C1_CLKS_MASK 0xC0u
+#define OSC_CR_ERCLKEN_MASK 0x80u
+#define OSC_CR_EREFSTEN_MASK 0x20u
+#define UART_BDH_SBR_MASK 0x1Fu
+#define UART_BDH_SBR(x) ((uint8_t)(x))
+#define UART_BDH_RXEDGIE_MASK 0x40u
+#define UART_BDL_SBR(x) ((uint8_t)(x))
+#define UART_C2_TE_MASK 0x8u
+#define UART_C2_RE_MASK 0x4u
+#define UART_C2_RIE_MASK 0x20u
+#define UART_C2_TIE_MASK 0x80u
+#define UART_C2_TCIE_MASK 0x40u
+#define UART_S1_RDRF_MASK 0x20u
+#define UART_S1_TDRE_MASK 0x80u
+#define UART_S1_TC_MASK 0x40u
+#define UART_S1_OR_MASK 0x8u
+#define UART_S1_NF_MASK 0x4u
+#define UART_S1_FE_MASK 0x2u
+#define UART_S1_PF_MASK 0x1u
+#define UART_S2_RXEDGIF_MASK 0x40u
+#define UART_C4_TDMAS_MASK 0x80u
+#define UART_C4_RDMAS_MASK 0x20u
+#define DMA_DSR_BCR_BCR(x) ((uint32_t)(x))
+#define DMA_DSR_BCR_BCR_MASK 0xFFFFFu
+#define DMA_DSR_BCR_DONE_MASK 0x1000000u
+#define DMA_DSR_BCR_BSY_MASK 0x2000000u
+#define DMA_DCR_ERQ_MASK 0x40000000u
+#define DMA_DCR_CS_MASK 0x20000000u
+#define DMA_DCR_EINT_MASK 0x80000000u
+#define DMA_DCR_SINC_MASK 0x400000u
+#define DMA_DCR_DINC_MASK 0x80000u
+#define DMA_DCR_SSIZE(x) (((uint32_t)(x))<<20)
+#define DMA_DCR_DSIZE(x) (((uint32_t)(x))<<17)
+#define DMA_DCR_D_REQ_MASK 0x80u
+#define DMA_DCR_SMOD(x) (((uint32_t)(x))<<12)
+#define DMA_DCR_DMOD(x) (((uint32_t)(x))<<8)
+#define DMA_DCR_LINKCC(x) (((uint32_t)(x))<<4)
+#define DMA_DCR_LCH1(x) (((uint32_t)(x))<<2)
+#define DMA_DCR_LCH2(x) ((uint32_t)(x))
+#define DMAMUX_CHCFG_ENBL_MASK 0x80u
+#define DMAMUX_CHCFG_SOURCE(x) ((uint8_t)(x))
+#define ADC_SC1_ADCH(x) ((uint32_t)(x))
+#define ADC_SC1_AIEN_MASK 0x40u
+#define ADC_SC1_COCO_MASK 0x80u
+#define ADC_CFG1_ADIV(x) (((uint32_t)(x))<<5)
+#define ADC_CFG1_MODE(x) (((uint32_t)(x))<<2)
+#define ADC_CFG1_ADLSMP_MASK 0x10u
+#define ADC_CFG1_ADICLK(x) ((uint32_t)(x))
+#define ADC_SC2_DMAEN_MASK 0x4u
+#define ADC_SC2_ADTRG_MASK 0x40u
+#define ADC_SC3_AVGE_MASK 0x4u
+#define ADC_SC3_AVGS(x) ((uint32_t)(x))
+#define ADC_SC3_CAL_MASK 0x80u
+#define ADC_SC3_CALF_MASK 0x40u
+#define ADC_SC3_ADCO_MASK 0x8u
+#define ADC_SC2_ADACT_MASK 0x80u
+#define DMA_DSR_BCR_CE_MASK 0x40000000u
+#define DMA_DSR_BCR_BES_MASK 0x20000000u
+#define DMA_DSR_BCR_BED_MASK 0x10000000u
+#define PIT_MCR_MDIS_MASK 0x2u
+#define PIT_MCR_FRZ_MASK 0x1u
+#define PIT_TCTRL_TEN_MASK 0x1u
+#define PIT_TCTRL_TIE_MASK 0x2u
+#define PIT_TFLG_TIF_MASK 0x1u
+#define SIM_SOPT7_ADC0ALTTRGEN_MASK 0x80u
+#define SIM_SOPT7_ADC0TRGSEL(x) ((uint32_t)(x))
+#define FTFA_FSTAT_CCIF_MASK 0x80u
+#define FTFA_FSTAT_RDCOLERR_MASK 0x40u
+#define FTFA_FSTAT_ACCERR_MASK 0x20u
+#define FTFA_FSTAT_FPVIOL_MASK 0x10u
+#define FTFA_FSTAT_MGSTAT0_MASK 0x1u
+#define SysTick_CTRL_CLKSOURCE_Msk 4u
+#define SysTick_LOAD_RELOAD_Msk 0xFFFFFFu
+#endif
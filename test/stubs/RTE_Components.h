@@ -0,0 +1 @@
+// RTE_Components.h (host stub)
@@ -0,0 +1,47 @@
+// cmsis_os2.h (host stub)
+// CMSIS-RTOS2 declarations; tests that link an RTOS user define the calls it makes.
+#ifndef CMSIS_OS2_H_
+#define CMSIS_OS2_H_
+#include <stdint.h>
+#include <stddef.h>
+typedef enum { osOK=0, osError=-1, osErrorTimeout=-2, osErrorResource=-3, osErrorParameter=-4, osErrorNoMemory=-5, osErrorISR=-6 } osStatus_t;
+typedef enum { osPriorityNone=0, osPriorityIdle=1, osPriorityLow=8, osPriorityBelowNormal=16, osPriorityNormal=24, osPriorityAboveNormal=32, osPriorityHigh=40, osPriorityRealtime=48, osPriorityISR=56 } osPriority_t;
+typedef void *osThreadId_t; typedef void *osMutexId_t; typedef void *osEventFlagsId_t; typedef void *osMessageQueueId_t; typedef void *osTimerId_t;
+typedef void (*osThreadFunc_t)(void *);
+typedef struct { const char *name; uint32_t attr_bits; void *cb_mem; uint32_t cb_size; void *stack_mem; uint32_t stack_size; osPriority_t priority; uint32_t tz_module; uint32_t reserved; } osThreadAttr_t;
+typedef struct { const char *name; uint32_t attr_bits; void *cb_mem; uint32_t cb_size; } osMutexAttr_t;
+typedef struct { const char *name; uint32_t attr_bits; void *cb_mem; uint32_t cb_size; } osEventFlagsAttr_t;
+typedef struct { const char *name; uint32_t attr_bits; void *cb_mem; uint32_t cb_size; void *mq_mem; uint32_t mq_size; } osMessageQueueAttr_t;
+#define osWaitForever 0xFFFFFFFFU
+#define osFlagsWaitAny 0U
+#define osFlagsWaitAll 1U
+#define osFlagsNoClear 2U
+#define osFlagsError 0x80000000U
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+#define osMutexPrioInherit 2U
+#define osMutexRecursive 1U
+typedef enum { osKernelInactive=0, osKernelReady=1, osKernelRunning=2, osKernelLocked=3, osKernelSuspended=4, osKernelError=-1 } osKernelState_t;
+osKernelState_t osKernelGetState(void);
+osStatus_t osKernelInitialize(void); osStatus_t osKernelStart(void);
+uint32_t osKernelGetTickCount(void); uint32_t osKernelGetTickFreq(void);
+uint32_t osKernelGetSysTimerCount(void); uint32_t osKernelGetSysTimerFreq(void);
+int32_t osKernelLock(void); int32_t osKernelUnlock(void); int32_t osKernelRestoreLock(int32_t);
+uint32_t osKernelSuspend(void); void osKernelResume(uint32_t);
+osThreadId_t osThreadNew(osThreadFunc_t, void *, const osThreadAttr_t *);
+osThreadId_t osThreadGetId(void); const char *osThreadGetName(osThreadId_t);
+uint32_t osThreadGetStackSpace(osThreadId_t); uint32_t osThreadGetStackSize(osThreadId_t);
+osStatus_t osThreadYield(void);
+uint32_t osThreadFlagsGet(void); uint32_t osThreadFlagsSet(osThreadId_t, uint32_t); uint32_t osThreadFlagsClear(uint32_t); uint32_t osThreadFlagsWait(uint32_t, uint32_t, uint32_t);
+osStatus_t osDelay(uint32_t); osStatus_t osDelayUntil(uint32_t);
+osMutexId_t osMutexNew(const osMutexAttr_t *); osStatus_t osMutexAcquire(osMutexId_t, uint32_t); osStatus_t osMutexRelease(osMutexId_t);
+const char *osMutexGetName(osMutexId_t);
+osEventFlagsId_t osEventFlagsNew(const osEventFlagsAttr_t *); uint32_t osEventFlagsSet(osEventFlagsId_t, uint32_t); uint32_t osEventFlagsClear(osEventFlagsId_t, uint32_t); uint32_t osEventFlagsGet(osEventFlagsId_t); uint32_t osEventFlagsWait(osEventFlagsId_t, uint32_t, uint32_t, uint32_t);
+osMessageQueueId_t osMessageQueueNew(uint32_t, uint32_t, const osMessageQueueAttr_t *);
+osStatus_t osMessageQueuePut(osMessageQueueId_t, const void *, uint8_t, uint32_t);
+osStatus_t osMessageQueueGet(osMessageQueueId_t, void *, uint8_t *, uint32_t);
+typedef void (*osTimerFunc_t)(void *);
+typedef enum { osTimerOnce=0, osTimerPeriodic=1 } osTimerType_t;
+typedef struct { const char *name; uint32_t attr_bits; void *cb_mem; uint32_t cb_size; } osTimerAttr_t;
+osTimerId_t osTimerNew(osTimerFunc_t, osTimerType_t, void *, const osTimerAttr_t *);
+osStatus_t osTimerStart(osTimerId_t, uint32_t); osStatus_t osTimerStop(osTimerId_t);
+#endif
@@ -0,0 +1,12 @@
+// rtx_os.h (host stub)
+// RTX5 control block sizes.
+#ifndef RTX_OS_H_
+#define RTX_OS_H_
+#include "cmsis_os2.h"
+typedef struct { uint8_t x[68]; } osRtxThread_t;
+typedef struct { uint8_t x[28]; } osRtxMutex_t;
+typedef struct { uint8_t x[16]; } osRtxEventFlags_t;
+#define osRtxThreadCbSize sizeof(osRtxThread_t)
+#define osRtxMutexCbSize sizeof(osRtxMutex_t)
+#define osRtxEventFlagsCbSize sizeof(osRtxEventFlags_t)
+#endif
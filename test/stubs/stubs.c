@@ -0,0 +1,44 @@
+// stubs.c
+// Register instances and intrinsics behind the host MKL25Z4.h. PRIMASK is
+// tracked so tests can check that critical sections are balanced, and NVIC
+// pending bits so they can tell whether a latched interrupt would still run.
+#include "MKL25Z4.h"
+
+SIM_Type SIM_s;
+PORT_Type PORTA_s, PORTB_s, PORTC_s, PORTD_s, PORTE_s;
+GPIO_Type PTA_s, PTB_s, PTC_s, PTD_s, PTE_s;
+TPM_Type TPM0_s, TPM1_s, TPM2_s;
+LPTMR_Type LPTMR0_s;
+SysTick_Type SysTick_s;
+SCB_Type SCB_s;
+SMC_Type SMC_s;
+MCG_Type MCG_s;
+OSC_Type OSC0_s;
+UART_Type UART1_s, UART2_s;
+DMA_Type DMA0_s;
+DMAMUX_Type DMAMUX0_s;
+ADC_Type ADC0_s;
+PIT_Type PIT_s;
+FTFA_Type FTFA_s;
+uint32_t SystemCoreClock = 48000000U;
+
+static uint32_t primask = 0;
+static uint32_t nvic_pending = 0;
+
+uint32_t __get_PRIMASK(void)        { return primask; }
+void     __set_PRIMASK(uint32_t v)  { primask = v & 1U; }
+void     __disable_irq(void)        { primask = 1U; }
+void     __enable_irq(void)         { primask = 0U; }
+uint32_t __get_IPSR(void)           { return 0; }
+void     __WFI(void)                {}
+void     __DSB(void)                {}
+void     __ISB(void)                {}
+void     __NOP(void)                {}
+void     SystemCoreClockUpdate(void) {}
+
+void NVIC_EnableIRQ(IRQn_Type irq)                    { (void)irq; }
+void NVIC_DisableIRQ(IRQn_Type irq)                   { (void)irq; }
+void NVIC_SetPriority(IRQn_Type irq, uint32_t prio)   { (void)irq; (void)prio; }
+void NVIC_ClearPendingIRQ(IRQn_Type irq)              { if (irq >= 0) nvic_pending &= ~(1U << irq); }
+void NVIC_SetPendingIRQ(IRQn_Type irq)                { if (irq >= 0) nvic_pending |= 1U << irq; }
+uint32_t NVIC_GetPendingIRQ(IRQn_Type irq)            { return (irq >= 0) ? (nvic_pending >> irq) & 1U : 0U; }
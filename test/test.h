@@ -0,0 +1,22 @@
+// test.h
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+// Minimal host test harness: CHECK() reports a failed condition with its
+// location and carries on, TEST_EXIT() is the exit status for make.
+
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_EXIT() (printf("%s: %s\n", __FILE__, test_failures ? "FAILED" : "ok"), \
+                     test_failures ? 1 : 0)
+
+#endif // TEST_H
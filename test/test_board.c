@@ -0,0 +1,119 @@
+// test_board.c
+// Port setup from the board pin map, against the stub PORT registers built
+// with PORT_ACCESS_LOG: every PCR, GPCLR and GPCHR access is counted and the
+// global pin control writes are replayed onto a model of the PCRs. The pin
+// setup of init_leds() from before the pin map is the baseline.
+#include <string.h>
+#include "test.h"
+#include "board.h"
+
+static PORT_Type *const ports[BOARD_NUM_PORTS] = { PORTA, PORTB, PORTC, PORTD, PORTE };
+
+static uint32_t accesses;
+static uint32_t global_writes;
+
+uint32_t port_access(int global) {
+    accesses++;
+    if (!global) {
+        return 0;
+    }
+    CHECK(global_writes < PORT_LOG_SIZE);
+    return global_writes++ % PORT_LOG_SIZE;
+}
+
+static void reset(void) {
+    for (int p = 0; p < BOARD_NUM_PORTS; p++) {
+        memset((void *)ports[p], 0, sizeof(PORT_Type));
+    }
+    accesses = 0;
+    global_writes = 0;
+}
+
+// init_leds() before the pin map: one read-modify-write per LED pin.
+static void baseline_led_pins(void) {
+    static const struct { PORT_Type *port; uint32_t pin; } leds[] = {
+        { PORTC, 7 }, { PORTC, 0 }, { PORTC, 3 }, { PORTC, 4 },
+        { PORTC, 5 }, { PORTC, 6 }, { PORTC, 10 }, { PORTC, 11 },
+        { PORTA, 1 }, { PORTA, 2 }, { PORTD, 4 }, { PORTA, 12 },
+        { PORTA, 4 }, { PORTA, 5 }, { PORTC, 8 }, { PORTC, 9 }
+    };
+    for (uint32_t i = 0; i < sizeof(leds) / sizeof(leds[0]); i++) {
+        PORT_Type *port = leds[i].port;
+        port->PCR[leds[i].pin] = (port->PCR[leds[i].pin] & ~PORT_PCR_MUX_MASK) | PORT_PCR_MUX(1);
+    }
+}
+
+// --- PCR Model ---
+// GPWE selects the pins, the low half-word is written to each of them.
+#define WRITTEN 0x80000000U
+static uint32_t pcr[BOARD_NUM_PORTS][32];
+
+static void replay(void) {
+    memset(pcr, 0, sizeof(pcr));
+    for (uint32_t w = 0; w < global_writes; w++) {
+        for (int p = 0; p < BOARD_NUM_PORTS; p++) {
+            uint32_t lo = ports[p]->GPCLR_[w];
+            uint32_t hi = ports[p]->GPCHR_[w];
+            for (int pin = 0; pin < 16; pin++) {
+                if (lo & (1U << (16 + pin))) {
+                    pcr[p][pin] = WRITTEN | (lo & 0xFFFFU);
+                }
+                if (hi & (1U << (16 + pin))) {
+                    pcr[p][16 + pin] = WRITTEN | (hi & 0xFFFFU);
+                }
+            }
+        }
+    }
+}
+
+#define CHECK_MUX(ctx, name, port, pin, mux, dir, level) \
+    CHECK(pcr[BOARD_PORT_##port][pin] == (WRITTEN | PORT_PCR_MUX(mux))); \
+    pins++;
+
+static void test_board_init(void) {
+    reset();
+    baseline_led_pins();
+    uint32_t baseline = accesses;
+    CHECK(baseline == 2 * 16);
+
+    reset();
+    board_init();
+    CHECK(accesses == global_writes); // No PCR is read or written directly
+    replay();
+    uint32_t pins = 0;
+    BOARD_PINS(CHECK_MUX, 0)
+    uint32_t written = 0;
+    for (int p = 0; p < BOARD_NUM_PORTS; p++) {
+        for (int pin = 0; pin < 32; pin++) {
+            written += (pcr[p][pin] & WRITTEN) ? 1U : 0U;
+        }
+    }
+    CHECK(written == pins); // Nothing outside the pin map
+    // One write per port, mux setting and half-port in use: A 1, B 2 (GPIO
+    // and TPM), C 3 (GPIO low and high, analog), D 1, E 2 (analog, UART).
+    CHECK(accesses == 9);
+    printf("board: %u pins in %u GPCLR/GPCHR writes, baseline 16 LED pins in %u PCR accesses\n",
+           (unsigned)pins, (unsigned)accesses, (unsigned)baseline);
+}
+
+// Outputs driven to their reset level before PDDR enables them.
+static void test_outputs(void) {
+    reset();
+    memset(&PTC_s, 0, sizeof(PTC_s));
+    board_init();
+    uint32_t leds_c = BOARD_MASK(LED_GREEN_0) | BOARD_MASK(LED_RED_6) | BOARD_MASK(LED_RED_7);
+    uint32_t motor = BOARD_MASK(MOTOR_LEFT_IN) | BOARD_MASK(MOTOR_RIGHT_OUT);
+    CHECK((PTC_s.PSOR & leds_c) == leds_c && (PTC_s.PSOR & motor) == 0);
+    CHECK((PTC_s.PCOR & motor) == motor && (PTC_s.PCOR & leds_c) == 0);
+    CHECK((PTC_s.PDDR & (leds_c | motor)) == (leds_c | motor));
+    CHECK((PTC_s.PDDR & BOARD_MASK(MOTOR_LEFT_SENSE)) == 0);
+    CHECK(PTB_s.PDDR == BOARD_MASK(OBSTACLE_TRIG));
+    CHECK(PTE_s.PDDR == 0);
+    CHECK((SIM_s.SCGC5 & BOARD_CLOCK_MASK) == BOARD_CLOCK_MASK);
+}
+
+int main(void) {
+    test_board_init();
+    test_outputs();
+    return TEST_EXIT();
+}
@@ -0,0 +1,116 @@
+// test_cmdtrace.c
+// Session record and replay through the real decoder, with a fake timebase
+// and a fake motor layer.
+#include <string.h>
+#include "test.h"
+#include "cmdtrace.h"
+#include "command.h"
+#include "motor.h"
+#include "audio.h"
+#include "envelope.h"
+#include "obstacle.h"
+#include "params.h"
+#include "melody.h"
+#include "uart.h"
+#include "telemetry.h"
+
+// --- Fakes ---
+static uint32_t now_us;
+static RobotState last_state;
+static uint32_t last_rx_us, move_calls;
+static uint8_t sent[256];
+static uint32_t sent_len;
+
+void motor_command(RobotState state, uint32_t rx_us) { last_state = state; last_rx_us = rx_us; move_calls++; }
+uint32_t timebase_now_us(void)                      { return now_us; }
+bool uart_tx_dma(const uint8_t *buf, uint32_t len)  { memcpy(sent + sent_len, buf, len); sent_len += len; return true; }
+bool uart_tx_busy(void)                             { return false; }
+osStatus_t osDelay(uint32_t ticks)                  { return osOK; }
+void envelope_set_volume(q15_t level)               {}
+bool params_set(ParamId id, int32_t value)          { return true; }
+void obstacle_set_reflex(uint16_t mm, ObstacleReflex reflex) {}
+void audio_set_playback(int8_t tempo, int8_t transpose) {}
+bool melody_write(const RingBuf *src, uint32_t offset, uint32_t len) { return true; }
+void uart_set_rx_thread(osThreadId_t thread)        {}
+uint32_t uart_last_rx_us(void)                      { return 0; }
+osThreadId_t osThreadGetId(void)                    { return NULL; }
+uint32_t osThreadFlagsWait(uint32_t f, uint32_t o, uint32_t t) { return 0; }
+volatile bool runComplete;
+RingBuf uart_rx;
+
+// --- Helpers ---
+static uint8_t storage[64];
+static RingBuf ring = RINGBUF_INIT(storage);
+
+static void send(uint8_t cmd, uint8_t arg, uint32_t rx_us) {
+    uint8_t bytes[5] = { CMD_SYNC, 1, cmd, arg, (uint8_t)~(1 + cmd + arg) };
+    for (int i = 0; i < 5; i++) {
+        ringbuf_put(&ring, bytes[i]);
+    }
+    command_poll(&ring, rx_us);
+}
+
+static size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t i = 0, o = 0;
+    while (i < len) {
+        uint8_t code = in[i++];
+        for (uint8_t j = 1; j < code && i < len; j++) {
+            out[o++] = in[i++];
+        }
+        if (code < 0xFF && i < len) {
+            out[o++] = 0;
+        }
+    }
+    return o;
+}
+
+// Two moves 500 ms apart with a state change in between. A move record is a
+// 3-byte time delta, the kind and the 5-byte frame: 9 bytes.
+static void test_record(void) {
+    now_us = 1000;
+    send(CMD_CMDTRACE, 0, now_us); // Record; not recorded itself
+    send(CMD_MOVE, CMD_DIR_FORWARD, 501000);
+    cmdtrace_state(ROBOT_MOVING_FORWARD, 501010);
+    send(CMD_MOVE, CMD_DIR_STOP, 1001000);
+    send(CMD_CMDTRACE, 1, 1001500); // Stop
+    cmdtrace_state(ROBOT_STATIONARY, 1002000); // Not recording any more
+    CHECK(cmdtrace_stats.records == 3);
+
+    // Dump: one telemetry packet with the whole 21-byte trace.
+    sent_len = 0;
+    send(CMD_CMDTRACE, 3, 1003000);
+    CHECK(sent_len > 0 && sent[sent_len - 1] == 0x00);
+    uint8_t packet[64];
+    size_t n = cobs_decode(sent, sent_len - 1, packet);
+    CHECK(n == 3 + 9 + 3 + 9);
+    CHECK(packet[0] == TELEMETRY_TYPE_CMDTRACE && packet[1] == 0 && packet[2] == 0);
+    static const uint8_t first[9] = { 0xA0, 0xC2, 0x1E, CMDTRACE_REC_FRAME,  // 500000 us
+                                      CMD_SYNC, 1, CMD_MOVE, CMD_DIR_FORWARD, (uint8_t)~(1 + CMD_MOVE + CMD_DIR_FORWARD) };
+    static const uint8_t state[3] = { 10, CMDTRACE_REC_STATE, ROBOT_MOVING_FORWARD };
+    CHECK(memcmp(packet + 3, first, 9) == 0);
+    CHECK(memcmp(packet + 12, state, 3) == 0);
+}
+
+// Replay feeds the frames back on the recorded schedule, skipping states.
+static void test_replay(void) {
+    move_calls = 0;
+    now_us = 2000000;
+    send(CMD_CMDTRACE, 2, now_us);
+    CHECK(cmdtrace_replay_poll() == 500);
+    CHECK(move_calls == 0);
+
+    now_us = 2500300;
+    CHECK(cmdtrace_replay_poll() == 500); // Next one due at 3000000
+    CHECK(move_calls == 1 && last_state == ROBOT_MOVING_FORWARD && last_rx_us == 2500300);
+
+    now_us = 3000000;
+    CHECK(cmdtrace_replay_poll() == osWaitForever);
+    CHECK(move_calls == 2 && last_state == ROBOT_STATIONARY);
+    CHECK(cmdtrace_stats.replayed == 2 && cmdtrace_stats.replay_late_max_us == 300);
+}
+
+int main(void) {
+    test_record();
+    test_replay();
+    return TEST_EXIT();
+}
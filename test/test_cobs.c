@@ -0,0 +1,76 @@
+// test_cobs.c
+// COBS encoder against published vectors and a reference decoder.
+#include <string.h>
+#include "test.h"
+#include "cobs.h"
+
+// Reference decoder: a code byte n is followed by n - 1 data bytes, and a
+// zero unless n is 0xFF or the frame ends.
+static size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t i = 0, o = 0;
+    while (i < len) {
+        uint8_t code = in[i++];
+        for (uint8_t j = 1; j < code && i < len; j++) {
+            out[o++] = in[i++];
+        }
+        if (code < 0xFF && i < len) {
+            out[o++] = 0;
+        }
+    }
+    return o;
+}
+
+static void check_vector(const uint8_t *in, size_t len, const uint8_t *expect, size_t expect_len) {
+    uint8_t out[16];
+    size_t n = cobs_encode(in, len, out);
+    CHECK(n == expect_len && memcmp(out, expect, n) == 0);
+}
+
+static void test_vectors(void) {
+    static const uint8_t z1[] = { 0x00 },                   e1[] = { 0x01, 0x01 };
+    static const uint8_t z2[] = { 0x00, 0x00 },             e2[] = { 0x01, 0x01, 0x01 };
+    static const uint8_t m[]  = { 0x11, 0x22, 0x00, 0x33 }, em[] = { 0x03, 0x11, 0x22, 0x02, 0x33 };
+    static const uint8_t nz[] = { 0x11, 0x22, 0x33, 0x44 }, en[] = { 0x05, 0x11, 0x22, 0x33, 0x44 };
+    static const uint8_t tz[] = { 0x11, 0x00, 0x00, 0x00 }, et[] = { 0x02, 0x11, 0x01, 0x01, 0x01 };
+    static const uint8_t e0[] = { 0x01 };
+    check_vector(NULL, 0, e0, 1);
+    check_vector(z1, sizeof(z1), e1, sizeof(e1));
+    check_vector(z2, sizeof(z2), e2, sizeof(e2));
+    check_vector(m, sizeof(m), em, sizeof(em));
+    check_vector(nz, sizeof(nz), en, sizeof(en));
+    check_vector(tz, sizeof(tz), et, sizeof(et));
+}
+
+// 254 non-zero bytes fill one block: 0xFF, the data, then an empty block.
+static void test_full_block(void) {
+    uint8_t in[254], out[COBS_MAX_ENCODED(254)];
+    for (int i = 0; i < 254; i++) {
+        in[i] = (uint8_t)(i + 1);
+    }
+    size_t n = cobs_encode(in, sizeof(in), out);
+    CHECK(n == 256 && out[0] == 0xFF && out[1] == 0x01 && out[254] == 0xFE && out[255] == 0x01);
+}
+
+// Random records with runs of zeros: no zero on the wire, within
+// COBS_MAX_ENCODED, and decoded back unchanged.
+static void test_round_trip(void) {
+    static uint8_t in[700], out[COBS_MAX_ENCODED(700)], back[700];
+    uint32_t seed = 1;
+    for (size_t len = 0; len <= sizeof(in); len += (len < 520) ? 1 : 60) {
+        for (size_t i = 0; i < len; i++) {
+            seed = seed * 1103515245U + 12345U;
+            in[i] = ((seed >> 16) % 5 == 0) ? 0 : (uint8_t)(seed >> 24);
+        }
+        size_t n = cobs_encode(in, len, out);
+        CHECK(n <= COBS_MAX_ENCODED(len));
+        CHECK(memchr(out, 0, n) == NULL);
+        CHECK(cobs_decode(out, n, back) == len && memcmp(in, back, len) == 0);
+    }
+}
+
+int main(void) {
+    test_vectors();
+    test_full_block();
+    test_round_trip();
+    return TEST_EXIT();
+}
@@ -0,0 +1,194 @@
+// test_command.c
+// ringbuf.h and the command decoder, fed in-memory byte streams. The handlers'
+// targets are fakes that record the last call.
+#include <string.h>
+#include "test.h"
+#include "ringbuf.h"
+#include "command.h"
+#include "motor.h"
+#include "audio.h"
+#include "envelope.h"
+#include "obstacle.h"
+#include "params.h"
+#include "melody.h"
+#include "uart.h"
+
+// --- Fakes ---
+static RobotState last_state;
+static uint32_t last_rx_us, move_calls, volume_calls, param_calls;
+static q15_t last_volume;
+static ParamId last_param;
+static int32_t last_value;
+
+void motor_command(RobotState state, uint32_t rx_us) { last_state = state; last_rx_us = rx_us; move_calls++; }
+void envelope_set_volume(q15_t level)                { last_volume = level; volume_calls++; }
+bool params_set(ParamId id, int32_t value)           { last_param = id; last_value = value; param_calls++; return true; }
+void obstacle_set_reflex(uint16_t mm, ObstacleReflex reflex) {}
+void audio_set_playback(int8_t tempo, int8_t transpose) {}
+bool melody_write(const RingBuf *src, uint32_t offset, uint32_t len) { return true; }
+void uart_set_rx_thread(osThreadId_t thread) {}
+uint32_t uart_last_rx_us(void)                     { return 0; }
+uint32_t timebase_now_us(void)                     { return 0; }
+osThreadId_t osThreadGetId(void)                   { return NULL; }
+uint32_t osThreadFlagsWait(uint32_t f, uint32_t o, uint32_t t) { return 0; }
+volatile bool runComplete;
+RingBuf uart_rx;
+
+// --- Helpers ---
+static uint8_t storage[64];
+static RingBuf ring = RINGBUF_INIT(storage);
+
+static void put_bytes(const uint8_t *bytes, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        CHECK(ringbuf_put(&ring, bytes[i]));
+    }
+}
+
+// Builds SYNC LEN CMD ARG.. CHK into out; returns its length.
+static uint32_t frame(uint8_t *out, uint8_t cmd, const uint8_t *args, uint8_t len) {
+    uint8_t sum = (uint8_t)(len + cmd);
+    out[0] = CMD_SYNC;
+    out[1] = len;
+    out[2] = cmd;
+    for (uint8_t i = 0; i < len; i++) {
+        out[3 + i] = args[i];
+        sum = (uint8_t)(sum + args[i]);
+    }
+    out[3 + len] = (uint8_t)~sum;
+    return CMD_FRAME_BYTES(len);
+}
+
+static void reset(void) {
+    ring.head = ring.tail = 0;
+    memset((void *)&command_stats, 0, sizeof(command_stats));
+    move_calls = volume_calls = param_calls = 0;
+}
+
+// --- ringbuf.h ---
+static void test_ringbuf(void) {
+    uint8_t data[8];
+    RingBuf rb = RINGBUF_INIT(data);
+    uint8_t byte;
+    CHECK(ringbuf_count(&rb) == 0 && ringbuf_space(&rb) == 8);
+    CHECK(!ringbuf_get(&rb, &byte));
+    for (uint8_t i = 0; i < 8; i++) {
+        CHECK(ringbuf_put(&rb, i));
+    }
+    CHECK(!ringbuf_put(&rb, 99)); // Full
+    CHECK(ringbuf_count(&rb) == 8 && ringbuf_space(&rb) == 0);
+    CHECK(ringbuf_peek(&rb, 3) == 3);
+    ringbuf_skip(&rb, 2);
+    CHECK(ringbuf_get(&rb, &byte) && byte == 2);
+
+    // Free-running counters across the 32-bit wrap.
+    rb.head = rb.tail = UINT32_MAX - 2U;
+    for (uint8_t i = 0; i < 6; i++) {
+        CHECK(ringbuf_put(&rb, (uint8_t)(10 + i)));
+    }
+    CHECK(ringbuf_count(&rb) == 6 && ringbuf_space(&rb) == 2);
+    for (uint8_t i = 0; i < 6; i++) {
+        CHECK(ringbuf_get(&rb, &byte) && byte == 10 + i);
+    }
+    CHECK(ringbuf_count(&rb) == 0);
+}
+
+// --- Decoder ---
+static void test_valid_frame(void) {
+    uint8_t buf[40];
+    uint8_t arg = CMD_DIR_FORWARD;
+    reset();
+    put_bytes(buf, frame(buf, CMD_MOVE, &arg, 1));
+    command_poll(&ring, 1234U);
+    CHECK(move_calls == 1 && last_state == ROBOT_MOVING_FORWARD && last_rx_us == 1234U);
+    CHECK(command_stats.frames == 1 && ringbuf_count(&ring) == 0);
+}
+
+// Noise before SYNC is skipped and counted; the frame behind it still decodes.
+static void test_resync(void) {
+    uint8_t buf[40];
+    uint8_t arg = CMD_DIR_LEFT;
+    static const uint8_t noise[] = { 0x00, 0x13, 0x37 };
+    reset();
+    put_bytes(noise, sizeof(noise));
+    put_bytes(buf, frame(buf, CMD_MOVE, &arg, 1));
+    command_poll(&ring, 0);
+    CHECK(command_stats.skipped_bytes == 3);
+    CHECK(move_calls == 1 && last_state == ROBOT_MOVING_LEFT);
+}
+
+// A partial frame waits in the ring until the rest arrives.
+static void test_partial_frame(void) {
+    uint8_t buf[40];
+    uint8_t args[5] = { PARAM_MOTOR_TURN_MS, 0x20, 0x03, 0, 0 };
+    reset();
+    uint32_t n = frame(buf, CMD_PARAM, args, 5);
+    put_bytes(buf, 4);
+    command_poll(&ring, 0);
+    CHECK(param_calls == 0 && ringbuf_count(&ring) == 4);
+    put_bytes(buf + 4, n - 4);
+    command_poll(&ring, 0);
+    CHECK(param_calls == 1 && last_param == PARAM_MOTOR_TURN_MS && last_value == 800);
+    CHECK(ringbuf_count(&ring) == 0);
+}
+
+// A bad checksum drops only the SYNC byte, so a good frame right behind a
+// corrupted one is found again.
+static void test_bad_checksum(void) {
+    uint8_t buf[40];
+    uint8_t arg = CMD_DIR_BACK;
+    reset();
+    uint32_t n = frame(buf, CMD_MOVE, &arg, 1);
+    buf[n - 1] ^= 0x01;
+    put_bytes(buf, n);
+    put_bytes(buf, frame(buf, CMD_MOVE, &arg, 1));
+    command_poll(&ring, 0);
+    CHECK(command_stats.bad_checksum == 1);
+    CHECK(move_calls == 1 && last_state == ROBOT_MOVING_BACK);
+}
+
+static void test_bad_length(void) {
+    static const uint8_t bytes[] = { CMD_SYNC, CMD_MAX_ARGS + 1, CMD_MOVE };
+    uint8_t buf[40];
+    uint8_t arg = 9; // Not a CmdDirection
+    reset();
+    put_bytes(bytes, sizeof(bytes));
+    command_poll(&ring, 0);
+    CHECK(command_stats.bad_length == 1 && ringbuf_count(&ring) == 0);
+    put_bytes(buf, frame(buf, CMD_MOVE, &arg, 1));
+    command_poll(&ring, 0);
+    CHECK(command_stats.bad_length == 2 && move_calls == 0);
+}
+
+static void test_unknown_and_volume(void) {
+    uint8_t buf[40];
+    uint8_t arg = 255;
+    reset();
+    put_bytes(buf, frame(buf, 0x7E, NULL, 0));
+    put_bytes(buf, frame(buf, CMD_VOLUME, &arg, 1));
+    command_poll(&ring, 0);
+    CHECK(command_stats.unknown == 1);
+    CHECK(volume_calls == 1 && last_volume == fix_gamma8(255));
+}
+
+// Frames that straddle the end of the ring's storage decode in place.
+static void test_wrapped_frame(void) {
+    uint8_t buf[40];
+    uint8_t arg = CMD_DIR_RIGHT;
+    reset();
+    ring.head = ring.tail = sizeof(storage) - 2U;
+    put_bytes(buf, frame(buf, CMD_MOVE, &arg, 1));
+    command_poll(&ring, 0);
+    CHECK(move_calls == 1 && last_state == ROBOT_MOVING_RIGHT);
+}
+
+int main(void) {
+    test_ringbuf();
+    test_valid_frame();
+    test_resync();
+    test_partial_frame();
+    test_bad_checksum();
+    test_bad_length();
+    test_unknown_and_volume();
+    test_wrapped_frame();
+    return TEST_EXIT();
+}
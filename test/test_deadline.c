@@ -0,0 +1,70 @@
+// test_deadline.c
+// Deadline monitor with a fake kernel system timer (48 cycles per us), for the
+// periodic case and the sporadic input-to-output case the motor thread uses.
+#include "test.h"
+#include "cmsis_os2.h"
+#include "deadline.h"
+
+#define CYCLES_PER_US 48U
+
+static uint32_t now_cycles = 0xFFF00000U; // Wraps during the test
+
+uint32_t osKernelGetSysTimerCount(void) { return now_cycles; }
+uint32_t osKernelGetSysTimerFreq(void)  { return CYCLES_PER_US * 1000000U; }
+int32_t  osKernelLock(void)             { return 0; }
+int32_t  osKernelRestoreLock(int32_t l) { return l; }
+
+static void advance_us(uint32_t us) {
+    now_cycles += us * CYCLES_PER_US;
+}
+
+// 10 ms period: a late release is jitter, a job ending past the period a miss.
+static void test_periodic(void) {
+    DeadlineStats stats;
+    int task = deadline_register("led", 10, 1);
+    for (int i = 0; i < 3; i++) {
+        deadline_release(task);
+        advance_us(400);
+        deadline_complete(task);
+        advance_us(9600);
+    }
+    advance_us(300);
+    deadline_release(task);
+    advance_us(9800);
+    deadline_complete(task);
+    deadline_get(task, &stats);
+    CHECK(stats.jobs == 4 && stats.misses == 1 && stats.overruns == 1);
+    CHECK(stats.max_jitter_us == 300 && stats.max_exec_us == 9800);
+}
+
+// Command-to-pin: each job released at the input's stamp, 2 ms deadline.
+static void test_sporadic(void) {
+    DeadlineStats stats;
+    int task = deadline_register("motor", 2, 1);
+
+    advance_us(123456);
+    deadline_resync(task);
+    deadline_release_ago(task, 150); // Byte arrived 150 us ago
+    advance_us(20);
+    deadline_complete(task);
+    deadline_get(task, &stats);
+    CHECK(stats.jobs == 1 && stats.misses == 0 && stats.overruns == 0);
+    CHECK(stats.max_exec_us == 170 && stats.max_jitter_us == 0);
+
+    // Held up 2.5 ms behind a higher-priority thread: a miss and an overrun,
+    // although the motor thread itself only ran for 20 us.
+    advance_us(500000);
+    deadline_resync(task);
+    deadline_release_ago(task, 2500);
+    advance_us(20);
+    deadline_complete(task);
+    deadline_get(task, &stats);
+    CHECK(stats.jobs == 2 && stats.misses == 1 && stats.overruns == 1);
+    CHECK(stats.max_exec_us == 2520 && stats.max_response_us == 2520);
+}
+
+int main(void) {
+    test_periodic();
+    test_sporadic();
+    return TEST_EXIT();
+}
@@ -0,0 +1,135 @@
+// test_envelope.c
+// Duty tables and the TPM0 schedule of envelope.c, with the timer simulated:
+// each overflow advances the clock by TPM0's period and runs the interrupt.
+#include <math.h>
+#include <stdbool.h>
+#include "test.h"
+#include "MKL25Z4.h"
+#include "envelope.h"
+
+void TPM0_IRQHandler(void);
+
+#define HALF_PERIOD  2272U   // 220 Hz: TPM1 MOD = 4543
+#define TRACE_MS     400
+
+static int32_t duty_at[TRACE_MS];    // C0V after each ms, -1 = not written then
+static uint32_t interrupts;
+
+static bool tick_running(void) {
+    return (TPM0->SC & TPM_SC_CMOD_MASK) != 0;
+}
+
+// Runs a note to its end; duty_at[] records what C0V was set to when.
+static void play(uint32_t duration_ms) {
+    for (int i = 0; i < TRACE_MS; i++) {
+        duty_at[i] = -1;
+    }
+    interrupts = 0;
+    TPM1->MOD = 2U * HALF_PERIOD - 1U;
+    TPM1->CONTROLS[0].CnV = 0xFFFFU;
+    envelope_note(duration_ms);
+    duty_at[0] = (int32_t)TPM1->CONTROLS[0].CnV;
+    uint32_t now = 0;
+    while (tick_running() && now < TRACE_MS) {
+        CHECK(TPM0->MOD <= 0xFFFFU);
+        now += (TPM0->MOD + 1U) / 1000U;
+        uint32_t before = TPM1->CONTROLS[0].CnV;
+        TPM1->CONTROLS[0].CnV = 0xFFFFU;
+        TPM0_IRQHandler();
+        interrupts++;
+        if (TPM1->CONTROLS[0].CnV == 0xFFFFU) {
+            TPM1->CONTROLS[0].CnV = before; // A hop: nothing written
+        } else if (now < TRACE_MS) {
+            duty_at[now] = (int32_t)TPM1->CONTROLS[0].CnV;
+        }
+    }
+}
+
+static double head_level(int t) {
+    static const double shape[ENVELOPE_HEAD_MS] = {
+        0.25, 0.50, 0.75, 1.0, 0.92, 0.86, 0.81, 0.77,
+        0.73, 0.70, 0.67, 0.65, 0.63, 0.62, 0.61, 0.60
+    };
+    return shape[t] * HALF_PERIOD;
+}
+
+static double tail_level(int r) {
+    static const double shape[ENVELOPE_RELEASE_MS] = {
+        0.85, 0.70, 0.57, 0.46, 0.36, 0.28, 0.21, 0.15, 0.10, 0.06, 0.03, 0.0
+    };
+    return shape[r] * 0.60 * HALF_PERIOD;
+}
+
+// Duties within two counts of the shape at full volume; the head and tail are
+// stepped every ms and the sustain only costs a few hops.
+static void test_timed_note(void) {
+    play(200);
+    for (int t = 0; t < ENVELOPE_HEAD_MS; t++) {
+        CHECK(duty_at[t] >= 0 && fabs(duty_at[t] - head_level(t)) <= 2.0);
+    }
+    int release = 200 - ENVELOPE_RELEASE_MS;
+    for (int t = ENVELOPE_HEAD_MS; t < release; t++) {
+        CHECK(duty_at[t] == -1);
+    }
+    for (int r = 0; r < ENVELOPE_RELEASE_MS; r++) {
+        CHECK(duty_at[release + r] >= 0 && fabs(duty_at[release + r] - tail_level(r)) <= 2.0);
+    }
+    CHECK(TPM1->CONTROLS[0].CnV == 0);
+    CHECK(!tick_running());
+    // 15 head steps, hops of 65 + 65 + 43 ms (the last one writes the first
+    // tail entry), 11 more tail steps: 29 against 199 at one per ms.
+    printf("envelope: 200 ms note, %u interrupts\n", (unsigned)interrupts);
+    CHECK(interrupts == (ENVELOPE_HEAD_MS - 1) + 3 + (ENVELOPE_RELEASE_MS - 1));
+}
+
+// Held until the next note: the tick stops after the head, at sustain level.
+static void test_held_note(void) {
+    play(0);
+    CHECK(!tick_running());
+    CHECK(interrupts == ENVELOPE_HEAD_MS - 1);
+    CHECK(fabs(TPM1->CONTROLS[0].CnV - head_level(ENVELOPE_HEAD_MS - 1)) <= 2.0);
+}
+
+// Shorter than the release: the tail starts at once.
+static void test_short_note(void) {
+    play(5);
+    for (int r = 0; r < ENVELOPE_RELEASE_MS; r++) {
+        CHECK(duty_at[r] >= 0 && fabs(duty_at[r] - tail_level(r)) <= 2.0);
+    }
+    CHECK(!tick_running());
+}
+
+// Half volume halves every entry.
+static void test_volume(void) {
+    envelope_set_volume(Q15(0.5));
+    play(100);
+    CHECK(fabs(duty_at[3] - 0.5 * HALF_PERIOD) <= 2.0);
+    envelope_set_volume(Q15_ONE_MINUS);
+}
+
+// An overflow latched just before the next note starts must not step it: the
+// new note keeps its first head entry until its own tick.
+static void test_stale_overflow(void) {
+    play(0);
+    TPM1->CONTROLS[0].CnV = 0xFFFFU;
+    envelope_note(200);
+    uint32_t first = TPM1->CONTROLS[0].CnV;
+    NVIC_SetPendingIRQ(TPM0_IRQn);  // The held note's last overflow ...
+    envelope_note(200);             // ... before the thread starts the next note
+    if (NVIC_GetPendingIRQ(TPM0_IRQn)) {
+        TPM0_IRQHandler();
+    }
+    CHECK(TPM1->CONTROLS[0].CnV == first);
+    CHECK(fabs(first - head_level(0)) <= 2.0);
+    envelope_off();
+}
+
+int main(void) {
+    envelope_init();
+    test_timed_note();
+    test_held_note();
+    test_short_note();
+    test_volume();
+    test_stale_overflow();
+    return TEST_EXIT();
+}
@@ -0,0 +1,96 @@
+// test_fixmath.c
+// Accuracy of the fixed-point helpers against double.
+#include <math.h>
+#include <stdint.h>
+#include "test.h"
+#include "fixmath.h"
+
+static uint32_t lcg_state = 12345U;
+
+static uint32_t lcg(void) {
+    lcg_state = lcg_state * 1664525U + 1013904223U;
+    return lcg_state;
+}
+
+// Exact while the quotient fits 16 bits, relative error below 2^-14 above.
+static void test_udiv16(void) {
+    double worst = 0.0;
+    CHECK(fix_udiv16(1234U, 0) == UINT32_MAX);
+    for (uint32_t d = 1; d <= 0xFFFFU; d++) {
+        uint32_t probes[8] = { 0, d - 1U, d, d * 0xFFFFU, d * 0x10000U - 1U,
+                               lcg() % (d * 0x10000U), lcg(), UINT32_MAX };
+        for (int i = 0; i < 8; i++) {
+            uint32_t n = probes[i];
+            uint32_t q = fix_udiv16(n, (uint16_t)d);
+            uint32_t exact = n / d;
+            if (exact <= 0xFFFFU) {
+                CHECK(q == exact);
+            } else {
+                double rel = fabs((double)q - (double)n / d) / ((double)n / d);
+                worst = rel > worst ? rel : worst;
+            }
+        }
+    }
+    printf("fix_udiv16: worst relative error above 16 bits %.2e\n", worst);
+    CHECK(worst < 1.0 / 16384.0);
+}
+
+// Within half an LSB of the rounded product; -1 * -1 saturates.
+static void test_q15_mul(void) {
+    for (int32_t a = INT16_MIN; a <= INT16_MAX; a += 7) {
+        for (int32_t b = INT16_MIN; b <= INT16_MAX; b += 251) {
+            double exact = (double)a * b / 32768.0;
+            double got = q15_mul((q15_t)a, (q15_t)b);
+            if (exact >= 32767.5) {
+                CHECK(got == INT16_MAX);
+            } else {
+                CHECK(fabs(got - exact) <= 0.5);
+            }
+        }
+    }
+    CHECK(q15_mul(INT16_MIN, INT16_MIN) == INT16_MAX);
+}
+
+// Within 0.8% of full scale of 32767 * (level / 255)^2.2, and monotonic.
+static void test_gamma8(void) {
+    double worst = 0.0;
+    q15_t prev = 0;
+    for (int level = 0; level <= 255; level++) {
+        q15_t g = fix_gamma8((uint8_t)level);
+        double err = fabs(g - 32767.0 * pow(level / 255.0, 2.2)) / 32767.0;
+        worst = err > worst ? err : worst;
+        CHECK(g >= prev);
+        prev = g;
+    }
+    CHECK(fix_gamma8(0) == 0);
+    CHECK(fix_gamma8(255) == 32767);
+    printf("fix_gamma8: worst error %.2f%% of full scale\n", worst * 100.0);
+    CHECK(worst < 0.008);
+}
+
+// x * 2^(steps / 12) within 2^-15 relative plus one unit of rounding, over
+// two octaves either way and the whole x range.
+static void test_scale_semitones(void) {
+    double worst = 0.0;
+    for (int32_t steps = -24; steps <= 24; steps++) {
+        for (uint32_t x = 1; x < 0x10000U; x += (x < 256U) ? 1U : 37U) {
+            double exact = x * pow(2.0, steps / 12.0);
+            double err = fabs(fix_scale_semitones(x, steps) - exact);
+            CHECK(err <= exact / 32768.0 + 1.0);
+            double rel = (exact >= 1024.0) ? err / exact : 0.0;
+            worst = rel > worst ? rel : worst;
+        }
+    }
+    CHECK(fix_scale_semitones(440U, 0) == 440U);
+    CHECK(fix_scale_semitones(440U, 12) == 880U);
+    CHECK(fix_scale_semitones(440U, -12) == 220U);
+    printf("fix_scale_semitones: worst relative error (x * ratio >= 1024) %.2e\n", worst);
+}
+
+int main(void) {
+    test_udiv16();
+    test_q15_mul();
+    test_gamma8();
+    test_scale_semitones();
+    return TEST_EXIT();
+}
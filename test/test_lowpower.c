@@ -0,0 +1,143 @@
+// test_lowpower.c
+// Mode choice and time accounting of the tickless idle (LED/audio profile,
+// the one that can use VLPS), driven the way osRtxIdleThread drives them:
+// a simulated coop thread draws an LED frame every 10 ms, and in the second
+// half a melody plays, whose envelope tick wakes the CPU every ms during the
+// head and tail of each note. Reports the share of time in each mode.
+#include <stdbool.h>
+#include <stdlib.h>
+#include "test.h"
+#include "cmsis_os2.h"
+#include "lowpower.h"
+
+#define FRAME_US      10000U
+#define FRAME_RUN_US  400U
+#define NOTE_US       250000U
+#define NOTE_RUN_US   150U
+#define ENV_ISR_US    5U
+#define ENVELOPE_HEAD 16U
+#define ENVELOPE_TAIL 12U
+#define VLPS_WAKE_US  60U      // PLL relock, counted as run time
+
+static uint32_t now_us;
+static uint32_t busy_us;       // Simulated run time, to check RUN against
+static uint32_t slept_us;
+static uint32_t ticks_back;
+
+// Only reached from osRtxIdleThread, which the test does not run.
+uint32_t timebase_now_us(void)            { return now_us; }
+void     timebase_set_alarm_us(uint32_t t) {}
+void     timebase_cancel_alarm(void)      {}
+void     sysstats_register_idle(void)     {}
+uint32_t osKernelSuspend(void)            { return 0; }
+void     osKernelResume(uint32_t ticks)   {}
+int32_t  osKernelLock(void)               { return 0; }
+int32_t  osKernelRestoreLock(int32_t l)   { return l; }
+
+// Next envelope interrupt after t, or UINT32_MAX when the note is sustaining.
+static uint32_t envelope_irq_after(uint32_t t, bool melody) {
+    if (!melody) {
+        return UINT32_MAX;
+    }
+    uint32_t in_note = t % NOTE_US;
+    uint32_t next = t - in_note + (in_note / 1000U + 1U) * 1000U;
+    uint32_t pos = next % NOTE_US;
+    if (pos < ENVELOPE_HEAD * 1000U || pos >= NOTE_US - ENVELOPE_TAIL * 1000U) {
+        return next;
+    }
+    return t - in_note + NOTE_US - ENVELOPE_TAIL * 1000U;
+}
+
+// Idle from now until the next frame is due, as the idle thread would:
+// suspend, sleep, hand the ticks back, repeat after every early wake-up.
+static void idle_until(LowPowerAccount *a, uint32_t due_us, bool melody) {
+    while ((int32_t)(due_us - now_us) > 0) {
+        uint32_t ticks = (due_us - now_us + 999U) / 1000U; // osKernelSuspend()
+        PowerMode mode = lowpower_choose_mode(ticks);
+        uint32_t start = now_us;
+        uint32_t alarm = lowpower_sleep_begin(a, start, ticks);
+        uint32_t irq = envelope_irq_after(start, melody);
+        bool early = irq != UINT32_MAX && (int32_t)(irq - alarm) < 0;
+        now_us = early ? irq : alarm;
+        uint32_t elapsed = lowpower_sleep_end(a, mode, start, now_us, ticks);
+
+        CHECK(elapsed <= ticks && a->carry_us < LOWPOWER_US_PER_TICK);
+        slept_us += now_us - start;
+        ticks_back += elapsed;
+        CHECK(ticks_back * LOWPOWER_US_PER_TICK + a->carry_us == slept_us); // No drift
+
+        uint32_t run = (mode == POWER_VLPS) ? VLPS_WAKE_US : 0;
+        if (early) {
+            run += ENV_ISR_US;
+        }
+        now_us += run;
+        busy_us += run;
+    }
+}
+
+static void simulate(LowPowerAccount *a, uint32_t duration_us, bool melody) {
+    uint32_t end = now_us + duration_us;
+    uint32_t next_frame = now_us;
+    while ((int32_t)(end - now_us) > 0) {
+        uint32_t run = FRAME_RUN_US;
+        if (melody && now_us % NOTE_US < FRAME_US) {
+            run += NOTE_RUN_US; // Note onset in the same job
+        }
+        now_us += run;
+        busy_us += run;
+        next_frame += FRAME_US;
+        idle_until(a, next_frame, melody);
+    }
+}
+
+static void report(const char *what, LowPowerAccount *a) {
+    LowPowerStats s = a->stats;
+    s.time_us[POWER_RUN] += now_us - a->last_wake_us;
+    uint16_t run = lowpower_permille(&s, POWER_RUN);
+    uint16_t wait = lowpower_permille(&s, POWER_WAIT);
+    uint16_t vlps = lowpower_permille(&s, POWER_VLPS);
+    printf("lowpower: %-26s RUN %3u  WAIT %3u  VLPS %3u permille (%u VLPS, %u WAIT entries)\n",
+           what, run, wait, vlps, (unsigned)s.entries[POWER_VLPS], (unsigned)s.entries[POWER_WAIT]);
+    CHECK(run + wait + vlps >= 998 && run + wait + vlps <= 1000);
+}
+
+static void test_choose_mode(void) {
+    CHECK(lowpower_choose_mode(1) == POWER_WAIT);
+    CHECK(lowpower_choose_mode(LOWPOWER_VLPS_MIN_TICKS - 1) == POWER_WAIT);
+    CHECK(lowpower_choose_mode(LOWPOWER_VLPS_MIN_TICKS) == POWER_VLPS);
+    CHECK(lowpower_choose_mode(osWaitForever) == POWER_VLPS);
+}
+
+// An alarm wake hands back exactly the ticks asked for; an early one keeps
+// the part tick for the next sleep, which is then shortened by it.
+static void test_carry(void) {
+    LowPowerAccount a = { .last_wake_us = 0 };
+    uint32_t at = lowpower_sleep_begin(&a, 100, 9);
+    CHECK(at == 9100);
+    CHECK(lowpower_sleep_end(&a, POWER_VLPS, 100, at, 9) == 9 && a.carry_us == 0);
+    lowpower_sleep_begin(&a, 9200, 9);
+    CHECK(lowpower_sleep_end(&a, POWER_WAIT, 9200, 11950, 9) == 2 && a.carry_us == 750);
+    CHECK(lowpower_sleep_begin(&a, 12000, 3) == 12000 + 3000 - 750);
+    CHECK(lowpower_sleep_end(&a, POWER_WAIT, 12000, 14250, 3) == 3 && a.carry_us == 0);
+    CHECK(a.stats.time_us[POWER_RUN] == 100 + 100 + 50);
+    CHECK(a.stats.time_us[POWER_VLPS] == 9000 && a.stats.time_us[POWER_WAIT] == 2750 + 2250);
+}
+
+int main(void) {
+    test_choose_mode();
+    test_carry();
+
+    LowPowerAccount a = { .last_wake_us = now_us };
+    simulate(&a, 10000000U, false);
+    report("LED frames (10 s)", &a);
+    CHECK(a.stats.time_us[POWER_RUN] + now_us - a.last_wake_us == busy_us);
+    CHECK(lowpower_permille(&a.stats, POWER_VLPS) > 900);
+
+    LowPowerAccount b = { .last_wake_us = now_us };
+    busy_us = slept_us = ticks_back = 0;
+    simulate(&b, 10000000U, true);
+    report("LED frames + melody (10 s)", &b);
+    CHECK(b.stats.time_us[POWER_RUN] + now_us - b.last_wake_us == busy_us);
+    CHECK(b.stats.entries[POWER_WAIT] > 0 && lowpower_permille(&b.stats, POWER_VLPS) > 700);
+    return TEST_EXIT();
+}
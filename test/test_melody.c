@@ -0,0 +1,86 @@
+// test_melody.c
+// Note frequencies and the streaming ring's framing and backpressure.
+#include <math.h>
+#include "test.h"
+#include "melody.h"
+
+static uint32_t flags_set;
+
+uint32_t osThreadFlagsSet(osThreadId_t thread, uint32_t flags) { flags_set++; return flags; }
+
+// Equal temperament from A4 = 440 Hz, within half a hertz plus the rounding
+// of the top-octave table carried down by the shifts.
+static void test_note_hz(void) {
+    for (int note = MELODY_NOTE_MIN; note <= 127; note++) {
+        double exact = 440.0 * pow(2.0, (note - 69) / 12.0);
+        CHECK(fabs(melody_note_hz((uint8_t)note) - exact) <= 0.51 + exact / 8372.0);
+    }
+    CHECK(melody_note_hz(69) == 440);
+    CHECK(melody_note_hz(MELODY_REST) == 0);
+    CHECK(melody_note_hz(MELODY_NOTE_MIN - 1) == 0);
+    CHECK(melody_note_hz(MELODY_END) == 0);
+}
+
+// Frames as the decoder hands them over: note data at an offset in a ring.
+static uint8_t src_storage[64];
+static RingBuf src = RINGBUF_INIT(src_storage);
+
+static bool write_notes(const uint8_t *bytes, uint32_t len) {
+    src.head = src.tail = 0;
+    for (uint32_t i = 0; i < 3; i++) {
+        ringbuf_put(&src, 0xEE); // SYNC, LEN, CMD in front of the notes
+    }
+    for (uint32_t i = 0; i < len; i++) {
+        ringbuf_put(&src, bytes[i]);
+    }
+    return melody_write(&src, 3, len);
+}
+
+static void test_stream(void) {
+    static const uint8_t notes[] = { 69, 50, MELODY_REST, 0, 81, 25, MELODY_END, 1 };
+    static const uint8_t odd[] = { 69, 50, 70 };
+    static const uint8_t low[] = { MELODY_NOTE_MIN - 1, 10 };
+    MelodyNote note;
+
+    melody_set_player((osThreadId_t)1);
+    CHECK(!melody_pending() && !melody_next(&note));
+    CHECK(write_notes(notes, sizeof(notes)));
+    CHECK(flags_set == 1 && melody_stats.notes_queued == 4);
+    CHECK(melody_space() == MELODY_BUF_SIZE - sizeof(notes));
+
+    CHECK(!write_notes(odd, sizeof(odd)) && melody_stats.bad_frames == 1);
+    CHECK(!write_notes(low, sizeof(low)) && melody_stats.bad_frames == 2);
+
+    CHECK(melody_next(&note) && note.note == 69 && note.units == 50);
+    CHECK(melody_next(&note) && note.note == MELODY_REST && note.units == 1); // 0 reads as 1
+    CHECK(melody_next(&note) && note.note == 81 && note.units == 25);
+    CHECK(melody_next(&note) && note.note == MELODY_END);
+    CHECK(!melody_next(&note));
+}
+
+// A frame that does not fit is rejected whole; the credit says how much fits.
+static void test_backpressure(void) {
+    uint8_t frame[32];
+    for (uint32_t i = 0; i < sizeof(frame); i += 2) {
+        frame[i] = 60;
+        frame[i + 1] = 10;
+    }
+    uint32_t accepted = 0;
+    while (melody_space() >= sizeof(frame)) {
+        CHECK(write_notes(frame, sizeof(frame)));
+        accepted++;
+    }
+    CHECK(accepted == MELODY_BUF_SIZE / sizeof(frame));
+    CHECK(!write_notes(frame, 2) && melody_stats.rejected == 1);
+
+    MelodyNote note;
+    CHECK(melody_next(&note));
+    CHECK(melody_space() == 2 && write_notes(frame, 2));
+}
+
+int main(void) {
+    test_note_hz();
+    test_stream();
+    test_backpressure();
+    return TEST_EXIT();
+}
@@ -0,0 +1,82 @@
+// test_musclock.c
+// Musical clock between the audio task and a follower, on a fake timebase:
+// notes are published through the seqlock, the follower reads them a random
+// scheduling delay later and reports with musclock_followed(), as the LED
+// task does. The skew statistic must match the simulated audio-to-LED delay.
+#include <stdbool.h>
+#include <stdlib.h>
+#include "test.h"
+#include "musclock.h"
+
+#define NOTE_MS   250
+#define BEAT_MS   500
+#define NOTES     200
+#define MAX_DELAY 1500   // Audio job rest + LED frame work before the report
+
+static uint32_t now_us = 0xFFF00000U; // Wraps during the melody
+static uint32_t signals;
+
+uint32_t timebase_now_us(void) { return now_us; }
+void coop_signal(uint32_t s)   { signals |= s; }
+
+static void test_follow(void) {
+    uint32_t max_delay = 0;
+    uint32_t start = now_us;
+    musclock_start(BEAT_MS);
+    CHECK(musclock_playing());
+
+    for (uint32_t i = 0; i < NOTES; i++) {
+        // The audio task starts each note up to 300 us late.
+        now_us = start + i * NOTE_MS * 1000U + (uint32_t)rand() % 300U;
+        uint32_t onset = now_us;
+        signals = 0;
+        musclock_note(onset, NOTE_MS);
+        CHECK((signals & MUSCLOCK_FLAG_NOTE) != 0);
+        CHECK(((signals & MUSCLOCK_FLAG_BEAT) != 0) == (i % 2 == 0)); // Two notes per beat
+
+        uint32_t delay = 20U + (uint32_t)rand() % (MAX_DELAY - 20U);
+        now_us = onset + delay;
+        MusClock seen;
+        musclock_read(&seen);
+        CHECK(seen.note == i + 1 && seen.beat == i / 2 && seen.onset_us == onset);
+        CHECK(seen.duration_ms == NOTE_MS && seen.playing);
+        musclock_followed();
+        CHECK(musclock_stats.skew_last_us == delay);
+        if (delay > max_delay) {
+            max_delay = delay;
+        }
+    }
+    CHECK(musclock_stats.followed == NOTES);
+    CHECK(musclock_stats.skew_max_us == max_delay);
+    printf("musclock: %u notes, audio-to-LED skew max %u us\n",
+           (unsigned)musclock_stats.followed, (unsigned)musclock_stats.skew_max_us);
+
+    signals = 0;
+    musclock_stop();
+    CHECK(!musclock_playing() && signals == MUSCLOCK_FLAG_STOP);
+}
+
+// A note up to MUSCLOCK_BEAT_SLACK_US early is on the beat; a long rest
+// skips beats without raising a flag per beat.
+static void test_beats(void) {
+    MusClock seen;
+    uint32_t start = now_us;
+    musclock_start(BEAT_MS);
+    musclock_note(start, 2 * BEAT_MS);               // Beat 0, two beats long
+    signals = 0;
+    musclock_note(start + 2 * BEAT_MS * 1000U - MUSCLOCK_BEAT_SLACK_US, NOTE_MS);
+    musclock_read(&seen);
+    CHECK((signals & MUSCLOCK_FLAG_BEAT) != 0 && seen.beat == 2);
+    signals = 0;
+    musclock_note(start + 2 * BEAT_MS * 1000U + NOTE_MS * 1000U, NOTE_MS);
+    musclock_read(&seen);
+    CHECK((signals & MUSCLOCK_FLAG_BEAT) == 0 && seen.beat == 2);
+    musclock_stop();
+}
+
+int main(void) {
+    srand(1);
+    test_follow();
+    test_beats();
+    return TEST_EXIT();
+}
@@ -0,0 +1,163 @@
+// test_mutexprof.c
+// Wait and hold histograms of mutexprof.c (built with MUTEX_PROFILING) on a
+// fake system timer at 48 MHz. The fake mutex is either free or held; a
+// blocking acquire of a held one waits for 'release_after' cycles (the other
+// holder lets go) or fails if that is longer than the timeout.
+#include <string.h>
+#include "test.h"
+#include "mutexprof.h"
+#include "sysstats.h"
+
+#define TIMER_HZ 48000000U
+
+static uint32_t sys_now = 0xFFFFFF00U;
+static osThreadId_t running;
+static char mutex_obj, other_obj, thread_obj[2];
+#define MUTEX  ((osMutexId_t)&mutex_obj)
+#define OTHER  ((osMutexId_t)&other_obj)   // Not registered: no statistics
+
+static int held;
+static uint32_t release_after;
+
+uint32_t osKernelGetSysTimerCount(void) { return sys_now; }
+uint32_t osKernelGetSysTimerFreq(void) { return TIMER_HZ; }
+osThreadId_t osThreadGetId(void) { return running; }
+
+osStatus_t osMutexAcquire(osMutexId_t id, uint32_t timeout) {
+    if (held) {
+        if (timeout == 0) {
+            return osErrorResource;
+        }
+        if (release_after > timeout) {
+            sys_now += timeout;
+            return osErrorTimeout;
+        }
+        sys_now += release_after;
+    }
+    held = 1;
+    return osOK;
+}
+
+osStatus_t osMutexRelease(osMutexId_t id) {
+    held = 0;
+    return osOK;
+}
+
+// The sysstats slots of the two threads; anything else is unregistered.
+int sysstats_slot_of(osThreadId_t id) {
+    for (int i = 0; i < 2; i++) {
+        if (id == (osThreadId_t)&thread_obj[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void sysstats_get_thread(int index, SysStatsThread *out) {
+    memset(out, 0, sizeof(*out));
+    if (index >= 0 && index < 2) {
+        out->name = index == 0 ? "motor" : "telem";
+        out->id = (osThreadId_t)&thread_obj[index];
+    }
+}
+
+static void hold_for(uint32_t cycles) {
+    CHECK(MUTEX_ACQUIRE(MUTEX, osWaitForever) == osOK);
+    sys_now += cycles;
+    CHECK(MUTEX_RELEASE(MUTEX) == osOK);
+}
+
+static uint32_t bucket_count(const MutexProfHist *h) {
+    uint32_t n = 0;
+    for (int b = 0; b < MUTEXPROF_BUCKETS; b++) {
+        n += h->hist[b];
+    }
+    return n;
+}
+
+// Bucket 0 is below 2^6 cycles, bucket k covers [2^(k+5), 2^(k+6)), the last
+// one everything above.
+static void test_buckets(void) {
+    const MutexProfHist *h = &mutexprof_mutexes[0].hold;
+    static const struct { uint32_t cycles; int bucket; } cases[] = {
+        { 0, 0 }, { 63, 0 }, { 64, 1 }, { 127, 1 }, { 128, 2 },
+        { 48000, 10 }, { (1U << 28) - 1U, 22 }, { 1U << 28, 23 }, { 0xFFFFFFFFU, 23 }
+    };
+    running = (osThreadId_t)&thread_obj[0];
+    for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        mutexprof_reset();
+        hold_for(cases[i].cycles);
+        CHECK(h->hist[cases[i].bucket] == 1 && bucket_count(h) == 1);
+        CHECK(h->count == 1 && h->max_cycles == cases[i].cycles);
+        CHECK(mutexprof_threads[0].hold.hist[cases[i].bucket] == 1);
+        CHECK(mutexprof_mutexes[0].wait.hist[0] == 1); // Free: no wait
+    }
+}
+
+// A contended acquire books its wait to the mutex and the waiting thread; the
+// hold goes to whoever held it. A timeout only counts.
+static void test_contention(void) {
+    const MutexProfEntry *e = &mutexprof_mutexes[0];
+    mutexprof_reset();
+    running = (osThreadId_t)&thread_obj[0];
+    CHECK(MUTEX_ACQUIRE(MUTEX, osWaitForever) == osOK);   // Motor holds it ...
+    running = (osThreadId_t)&thread_obj[1];
+    release_after = 4800;                                 // ... for 100 us more
+    CHECK(MUTEX_ACQUIRE(MUTEX, osWaitForever) == osOK);
+    CHECK(e->contended == 1 && e->wait.count == 2 && e->wait.hist[7] == 1);
+    CHECK(mutexprof_threads[1].wait.hist[7] == 1 && mutexprof_threads[0].wait.hist[0] == 1);
+    CHECK(e->owner_slot == 1);
+    sys_now += 100;
+    CHECK(MUTEX_RELEASE(MUTEX) == osOK);
+    CHECK(mutexprof_threads[1].hold.hist[1] == 1 && mutexprof_threads[0].hold.count == 0);
+
+    held = 1;                                             // Someone else holds it
+    release_after = 1000;
+    CHECK(MUTEX_ACQUIRE(MUTEX, 10) == osErrorTimeout);
+    CHECK(MUTEX_ACQUIRE(MUTEX, 0) == osErrorResource);
+    CHECK(e->timeouts == 2 && e->contended == 1 && e->wait.count == 2);
+    held = 0;
+
+    // Unknown threads and mutexes are passed through without statistics.
+    running = NULL;
+    hold_for(100);
+    CHECK(e->hold.count == 2 && mutexprof_threads[0].hold.count == 0);
+    CHECK(MUTEX_ACQUIRE(OTHER, 0) == osOK && MUTEX_RELEASE(OTHER) == osOK);
+    CHECK(e->wait.count == 3 && e->owner_slot == -1);
+}
+
+static void test_saturation(void) {
+    mutexprof_reset();
+    running = (osThreadId_t)&thread_obj[0];
+    for (uint32_t i = 0; i < UINT16_MAX + 10U; i++) {
+        hold_for(10);
+    }
+    CHECK(mutexprof_mutexes[0].hold.hist[0] == UINT16_MAX);
+    CHECK(mutexprof_mutexes[0].hold.count == UINT16_MAX + 10U);
+}
+
+// 1 ms holds land below 1365 us (2^16 cycles).
+static void test_report(void) {
+    static char buf[512];
+    mutexprof_reset();
+    running = (osThreadId_t)&thread_obj[1];
+    hold_for(TIMER_HZ / 1000U);
+    size_t n = mutexprof_report(buf, sizeof(buf));
+    CHECK(n == strlen(buf));
+    CHECK(strstr(buf, "mutex uart: contended=0 timeouts=0\n") != NULL);
+    CHECK(strstr(buf, "hold   uart       n=1 avg=1000us max=1000us | <1365us:1\n") != NULL);
+    CHECK(strstr(buf, "hold   telem      n=1") != NULL && strstr(buf, "motor") == NULL);
+    const char *line = strstr(buf, "hold   uart");
+    printf("mutexprof: %.*s\n", (int)strcspn(line, "\n"), line);
+    CHECK(mutexprof_report(buf, 16) == 15);
+}
+
+int main(void) {
+    mutexprof_register(MUTEX, "uart");
+    mutexprof_register(MUTEX, "twice");
+    test_buckets();
+    test_contention();
+    test_saturation();
+    test_report();
+    return TEST_EXIT();
+}
@@ -0,0 +1,154 @@
+// test_obstacle.c
+// Echo capture path of obstacle.c with synthetic ECHO pulses: the capture
+// handler gets the 16-bit edge times as TPM2 channel 0 would deliver them, and
+// runs ISR_LATENCY_US after each edge on a fake timebase.
+#include <stdbool.h>
+#include "test.h"
+#include "MKL25Z4.h"
+#include "cmsis_os2.h"
+#include "board.h"
+#include "motor.h"
+#include "timebase.h"
+#include "obstacle.h"
+
+#define ISR_LATENCY_US 12
+
+static uint32_t now_us = 0x0001F000U;
+static TimebaseCaptureHandler capture;
+static int8_t   duty[2];
+static uint32_t reflex_stops;
+static uint32_t stopped_at_us;
+
+uint32_t timebase_now_us(void)  { return now_us; }
+void timebase_delay_us(uint32_t us) { now_us += us; }
+void timebase_capture_init(TimebaseCaptureHandler handler) { capture = handler; }
+osTimerId_t osTimerNew(osTimerFunc_t func, osTimerType_t type, void *arg, const osTimerAttr_t *attr) { return NULL; }
+osStatus_t  osTimerStart(osTimerId_t timer, uint32_t ticks) { return osOK; }
+
+void motor_get_duty(int8_t *left, int8_t *right) {
+    *left = duty[MOTOR_LEFT];
+    *right = duty[MOTOR_RIGHT];
+}
+
+void motor_reflex_stop(void) {
+    duty[MOTOR_LEFT] = duty[MOTOR_RIGHT] = 0;
+    reflex_stops++;
+    stopped_at_us = now_us;
+}
+
+static void set_echo(bool high) {
+    uint32_t *pdir = (uint32_t *)&BOARD_GPIO(OBSTACLE_ECHO)->PDIR;
+    *pdir = high ? (*pdir | BOARD_MASK(OBSTACLE_ECHO)) : (*pdir & ~BOARD_MASK(OBSTACLE_ECHO));
+}
+
+// One ECHO pulse of width_us starting now, then the rest of a ping period.
+static void echo(uint32_t width_us) {
+    uint32_t rise = now_us;
+    set_echo(true);
+    now_us = rise + ISR_LATENCY_US;
+    capture((uint16_t)rise);
+    set_echo(false);
+    now_us = rise + width_us + ISR_LATENCY_US;
+    capture((uint16_t)(rise + width_us));
+    now_us += OBSTACLE_PERIOD_MS * 1000U - width_us;
+}
+
+static uint32_t echo_us_for(uint32_t mm) {
+    return (mm * 10000U + 857U) / 1715U; // 0.1715 mm per us, rounded
+}
+
+static void drive_forward(void) {
+    duty[MOTOR_LEFT] = duty[MOTOR_RIGHT] = 100;
+}
+
+// Stops in the falling-edge interrupt itself once the reading is below the
+// stop distance, and reports the edge-to-stop latency.
+static void test_reflex(void) {
+    obstacle_set_reflex(OBSTACLE_STOP_MM, OBSTACLE_REFLEX_STOP);
+    for (uint32_t mm = OBSTACLE_STOP_MM + 10; mm >= OBSTACLE_STOP_MM - 10; mm--) {
+        drive_forward();
+        uint32_t stops = reflex_stops;
+        uint32_t fall = now_us + echo_us_for(mm);
+        echo(echo_us_for(mm));
+        uint32_t got = obstacle_stats.distance_mm;
+        CHECK(got + 1 >= mm && got <= mm + 1);
+        if (got < OBSTACLE_STOP_MM) {
+            CHECK(reflex_stops == stops + 1 && stopped_at_us - fall == ISR_LATENCY_US);
+            CHECK(obstacle_stats.reflex_latency_last_us == ISR_LATENCY_US);
+        } else {
+            CHECK(reflex_stops == stops && duty[MOTOR_LEFT] == 100);
+        }
+    }
+    CHECK(obstacle_stats.reflex_latency_max_us == ISR_LATENCY_US);
+    CHECK(obstacle_blocked());
+    printf("obstacle: echo edge -> motor stop %u us, %u reflex stops\n",
+           (unsigned)obstacle_stats.reflex_latency_max_us, (unsigned)obstacle_stats.reflex_stops);
+}
+
+// Only a forward drive is stopped, and only with the reflex on.
+static void test_not_forward(void) {
+    uint32_t stops = reflex_stops;
+    duty[MOTOR_LEFT] = 100;
+    duty[MOTOR_RIGHT] = -100; // Turning
+    echo(echo_us_for(50));
+    duty[MOTOR_LEFT] = duty[MOTOR_RIGHT] = -100;
+    echo(echo_us_for(50));
+    obstacle_set_reflex(OBSTACLE_STOP_MM, OBSTACLE_REFLEX_OFF);
+    drive_forward();
+    echo(echo_us_for(50));
+    CHECK(!obstacle_blocked());
+    CHECK(reflex_stops == stops);
+    obstacle_set_reflex(OBSTACLE_STOP_MM, OBSTACLE_REFLEX_STOP);
+}
+
+// The 16-bit capture wraps in the middle of the pulse.
+static void test_capture_wrap(void) {
+    now_us = (now_us | 0xFFFFU) - 200U;
+    drive_forward();
+    echo(echo_us_for(300));
+    CHECK(obstacle_stats.distance_mm >= 299 && obstacle_stats.distance_mm <= 301);
+    CHECK(duty[MOTOR_LEFT] == 100);
+}
+
+// No object: a 38 ms pulse. A pulse held past 65.5 ms would alias to a short
+// echo in the 16-bit capture; neither blocks or stops.
+static void test_out_of_range(void) {
+    uint32_t stops = reflex_stops;
+    uint32_t out = obstacle_stats.out_of_range;
+    drive_forward();
+    echo(38000);
+    CHECK(obstacle_stats.distance_mm == OBSTACLE_NO_ECHO_MM && !obstacle_blocked());
+    echo(65536U + echo_us_for(50));
+    CHECK(obstacle_stats.distance_mm == OBSTACLE_NO_ECHO_MM && !obstacle_blocked());
+    CHECK(obstacle_stats.out_of_range == out + 2);
+    CHECK(reflex_stops == stops && duty[MOTOR_LEFT] == 100);
+
+    // A falling edge without a rising one is not a reading.
+    uint32_t readings = obstacle_stats.measurements;
+    set_echo(false);
+    capture((uint16_t)now_us);
+    CHECK(obstacle_stats.measurements == readings);
+}
+
+// A close reading stops blocking once it is OBSTACLE_STALE_MS old.
+static void test_stale(void) {
+    duty[MOTOR_LEFT] = duty[MOTOR_RIGHT] = 0;
+    echo(echo_us_for(100));
+    CHECK(obstacle_blocked());
+    now_us += OBSTACLE_STALE_MS * 1000U - OBSTACLE_PERIOD_MS * 1000U;
+    CHECK(obstacle_blocked());
+    now_us += 1000U;
+    CHECK(!obstacle_blocked());
+}
+
+int main(void) {
+    obstacle_init();
+    CHECK(capture != NULL);
+    CHECK(!obstacle_blocked()); // No reading yet
+    test_reflex();
+    test_not_forward();
+    test_capture_wrap();
+    test_out_of_range();
+    test_stale();
+    return TEST_EXIT();
+}
@@ -0,0 +1,258 @@
+// test_params.c
+// The parameter log of params.c against a simulated FTFA and flash, with
+// resets at random points. The flash sectors are mapped at PARAMS_BASE and
+// shared between processes; each boot runs in a forked child that loads the
+// log and then updates random keys until the power is cut in the middle of a
+// flash command, or in half of the boots during its first sector erase. An
+// interrupted program leaves a random subset of its bits programmed, an
+// interrupted erase a random share of its bits erased. After every reset
+// each key must read as its last acknowledged value, or as the value of the
+// update that was cut.
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "test.h"
+#include "MKL25Z4.h"
+#include "params.h"
+#include "audio.h"
+#include "envelope.h"
+#include "obstacle.h"
+#include "powermon.h"
+#include "timebase.h"
+
+#define BOOTS      3000
+#define MAX_CUT    700     // Flash commands before the power is cut
+#define WORDS      (PARAMS_SECTORS * PARAMS_SECTOR_SIZE / 4U)
+#define ERASED     0xFFFFFFFFU
+#define FSTAT_MARK 0x100U  // Above the flag bits: cleared by any write
+
+// --- Driver Fakes ---
+static bool motor_busy;
+uint32_t timebase_now_us(void) { return 0; }
+void envelope_set_volume(q15_t volume) {}
+void audio_set_playback(int8_t tempo, int8_t transpose) {}
+int8_t audio_tempo(void) { return 0; }
+int8_t audio_transpose(void) { return 0; }
+void obstacle_set_reflex(uint16_t stop_mm, ObstacleReflex reflex) {}
+uint16_t obstacle_stop_mm(void) { return OBSTACLE_STOP_MM; }
+ObstacleReflex obstacle_reflex(void) { return OBSTACLE_REFLEX_STOP; }
+bool powermon_busy(void) { return motor_busy; }
+
+// --- Shared State ---
+typedef struct {
+    uint32_t cut;                       // Command on which this boot loses power
+    bool     cut_erase;                 // ... or on its first erase, if this is set
+    bool     booted;
+    int32_t  committed[PARAM_COUNT];    // Last acknowledged values
+    bool     inflight;                  // An update was running when power went
+    ParamId  inflight_key;
+    int32_t  inflight_value;
+    uint32_t lost;                      // Keys read back as neither
+    uint32_t updates;
+    uint32_t bad_updates;               // Appends that took other than 2 programs
+    uint32_t compactions;
+    uint32_t torn;
+    uint32_t max_records;
+} Shared;
+
+static Shared *shared;
+static volatile uint32_t *flash;        // PARAMS_BASE
+
+// --- FTFA Model ---
+static uint32_t fstat = FTFA_FSTAT_CCIF_MASK;
+static uint32_t commands, programs, erases;
+
+static uint32_t rand32(void) {
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+// Runs a launched command; on the cut one, leaves it half done and dies.
+static void run_command(void) {
+    uint8_t cmd = FTFA_s.FCCOB0;
+    uint32_t addr = ((uint32_t)FTFA_s.FCCOB1 << 16) | ((uint32_t)FTFA_s.FCCOB2 << 8) | FTFA_s.FCCOB3;
+    uint32_t data = ((uint32_t)FTFA_s.FCCOB4 << 24) | ((uint32_t)FTFA_s.FCCOB5 << 16) |
+                    ((uint32_t)FTFA_s.FCCOB6 << 8) | FTFA_s.FCCOB7;
+    if (addr < PARAMS_BASE || addr >= PARAMS_BASE + WORDS * 4U) {
+        fstat |= FTFA_FSTAT_FPVIOL_MASK; // Outside the parameter sectors
+        return;
+    }
+    uint32_t word = (addr - PARAMS_BASE) / 4U;
+    bool cut = (++commands == shared->cut) || (cmd == 0x09U && shared->cut_erase);
+    int partial = rand() % 3; // Not started, done or half-way
+    if (cmd == 0x06U && addr % 4U == 0) {
+        programs++;
+        uint32_t result = flash[word] & data;
+        if (cut) {
+            flash[word] = (partial == 0) ? flash[word] : (partial == 1) ? result : flash[word] & (data | rand32());
+            _exit(0);
+        }
+        flash[word] = result;
+        if (result != data) {
+            fstat |= FTFA_FSTAT_MGSTAT0_MASK; // Programmed over a programmed word
+        }
+    } else if (cmd == 0x09U && addr % PARAMS_SECTOR_SIZE == 0) {
+        erases++;
+        int progress = rand() % 6; // Each bit erased with probability 2^-progress
+        for (uint32_t i = 0; i < PARAMS_SECTOR_SIZE / 4U; i++) {
+            if (!cut || partial == 1) {
+                flash[word + i] = ERASED;
+            } else if (partial == 2) {
+                uint32_t mask = ERASED;
+                for (int n = 0; n < progress; n++) {
+                    mask &= rand32();
+                }
+                flash[word + i] |= mask;
+            }
+        }
+        if (cut) {
+            _exit(0);
+        }
+    } else {
+        fstat |= FTFA_FSTAT_ACCERR_MASK;
+    }
+}
+
+uint32_t ftfa_access(void) {
+    uint32_t seen = FTFA_s.FSTAT_[0];
+    if ((seen & FSTAT_MARK) == 0) { // Written since the last access
+        fstat &= ~(seen & (FTFA_FSTAT_ACCERR_MASK | FTFA_FSTAT_FPVIOL_MASK));
+        if (seen & FTFA_FSTAT_CCIF_MASK) {
+            fstat &= ~FTFA_FSTAT_MGSTAT0_MASK;
+            run_command();
+        }
+    }
+    FTFA_s.FSTAT_[0] = fstat | FSTAT_MARK;
+    return 0;
+}
+
+// --- Boots ---
+static const struct { ParamId key; int32_t min, max; } keys[] = {
+    { PARAM_MOTOR_STEP_MS, 50, 5000 },
+    { PARAM_MOTOR_TURN_MS, 50, 5000 },
+    { PARAM_LED_SCALE, 64, 1024 },
+    { PARAM_VOLUME, 0, 255 },
+    { PARAM_OBSTACLE_MM, 20, 4000 },
+};
+#define NUM_KEYS (sizeof(keys) / sizeof(keys[0]))
+
+// Loads the log and checks it against what the previous boots acknowledged.
+static void load(void) {
+    params_init();
+    for (uint32_t i = 0; i < NUM_KEYS; i++) {
+        ParamId k = keys[i].key;
+        int32_t v = params_get(k);
+        bool cut_update = shared->inflight && shared->inflight_key == k && shared->inflight_value == v;
+        if (shared->booted && v != shared->committed[k] && !cut_update) {
+            shared->lost++;
+        }
+        shared->committed[k] = v;
+    }
+    shared->booted = true;
+    shared->inflight = false;
+    shared->torn += params_stats.torn;
+    if (params_stats.records > shared->max_records) {
+        shared->max_records = params_stats.records;
+    }
+}
+
+static void run_until_cut(void) {
+    load();
+    for (;;) {
+        uint32_t i = (uint32_t)rand() % NUM_KEYS;
+        ParamId k = keys[i].key;
+        int32_t v = keys[i].min + rand() % (keys[i].max - keys[i].min + 1);
+        if (v == params_get(k)) {
+            continue;
+        }
+        shared->inflight_key = k;
+        shared->inflight_value = v;
+        shared->inflight = true;
+        uint32_t p0 = programs, e0 = erases;
+        if (!params_set(k, v)) {
+            shared->lost++; // Only a failed flash command refuses here
+            _exit(1);
+        }
+        shared->committed[k] = v;
+        shared->inflight = false;
+        if (erases == e0) {
+            shared->updates++;
+            if (programs - p0 != 2) {
+                shared->bad_updates++;
+            }
+        } else {
+            shared->compactions++;
+        }
+    }
+}
+
+static void test_resets(void) {
+    for (uint32_t b = 0; b < BOOTS; b++) {
+        shared->cut = 1U + (uint32_t)rand() % MAX_CUT;
+        shared->cut_erase = (rand() % 2) == 0; // Erases are rare: aim at half of them
+        uint32_t seed = (uint32_t)rand();
+        pid_t pid = fork();
+        if (pid == 0) {
+            srand(seed);
+            run_until_cut();
+        }
+        int status = 0;
+        CHECK(pid > 0 && waitpid(pid, &status, 0) == pid);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    CHECK(shared->lost == 0);
+    CHECK(shared->bad_updates == 0);
+    CHECK(shared->max_records <= PARAMS_RECORDS);
+    CHECK(shared->compactions > 0 && shared->torn > 0);
+    printf("params: %u resets, %u values lost; %u appends at 2 words each, %u compactions, %u torn records skipped\n",
+           BOOTS, (unsigned)shared->lost, (unsigned)shared->updates,
+           (unsigned)shared->compactions, (unsigned)shared->torn);
+}
+
+// An update that needs a compaction is refused while a motor runs, and goes
+// through once it stands. This boot is the parent's: no power cut.
+static void test_refused(void) {
+    shared->cut = 0;
+    shared->cut_erase = false;
+    load();
+    CHECK(shared->lost == 0);
+    motor_busy = true;
+    int32_t v = params_get(PARAM_NOTE_MS);
+    uint32_t n = 0;
+    do {
+        v = (v == 100) ? 200 : 100;
+        n++;
+    } while (params_set(PARAM_NOTE_MS, v) && n <= PARAMS_RECORDS);
+    CHECK(params_stats.refused == 1 && erases == 0);
+    CHECK(params_get(PARAM_NOTE_MS) != v);
+    motor_busy = false;
+    CHECK(params_set(PARAM_NOTE_MS, v) && params_get(PARAM_NOTE_MS) == v);
+    CHECK(erases == 1 && params_stats.compactions == 1);
+    for (uint32_t i = 0; i < NUM_KEYS; i++) {
+        CHECK(params_get(keys[i].key) == shared->committed[keys[i].key]);
+    }
+}
+
+int main(void) {
+    // The parameter sectors at their target address; the page holding them
+    // is above the usual mmap_min_addr.
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t base = PARAMS_BASE & ~(page - 1U);
+    void *map = mmap((void *)base, PARAMS_BASE + WORDS * 4U - base, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    shared = mmap(NULL, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    CHECK(map == (void *)base && shared != MAP_FAILED);
+    if (map != (void *)base || shared == MAP_FAILED) {
+        return TEST_EXIT();
+    }
+    flash = (volatile uint32_t *)(uintptr_t)PARAMS_BASE;
+    memset((void *)flash, 0xFF, WORDS * 4U);
+    memset(shared, 0, sizeof(*shared));
+
+    srand(1);
+    test_resets();
+    test_refused();
+    return TEST_EXIT();
+}
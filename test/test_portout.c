@@ -0,0 +1,94 @@
+// test_portout.c
+// Batched port writes, and the motor state transitions they produce: for
+// every pair of motor states, what the H-bridge inputs see between the
+// PCOR and the PSOR write of one commit.
+#include <stdbool.h>
+#include "test.h"
+#include "portout.h"
+
+#define LEFT_IN    BOARD_MASK(MOTOR_LEFT_IN)
+#define LEFT_OUT   BOARD_MASK(MOTOR_LEFT_OUT)
+#define RIGHT_IN   BOARD_MASK(MOTOR_RIGHT_IN)
+#define RIGHT_OUT  BOARD_MASK(MOTOR_RIGHT_OUT)
+#define MOTOR_PINS (LEFT_IN | LEFT_OUT | RIGHT_IN | RIGHT_OUT)
+
+// Pin levels of moveStop, moveUp, moveBack, moveLeft and moveRight (motor.c).
+static const uint32_t motor_states[5] = {
+    MOTOR_PINS,                 // Stop: both sides brake
+    LEFT_IN | RIGHT_IN,         // Forward
+    LEFT_OUT | RIGHT_OUT,       // Back
+    LEFT_OUT | RIGHT_IN,        // Left
+    RIGHT_OUT | LEFT_IN,        // Right
+};
+
+// Staging: a later call for the same pin wins, and no pin is both set and
+// cleared.
+static void test_stage(void) {
+    PortOutBatch batch = PORTOUT_BATCH_INIT;
+    portout_stage(&batch, BOARD_PORT_C, 0x0F, 0x05);
+    portout_stage(&batch, BOARD_PORT_C, 0x03, 0x02);
+    CHECK(batch.set[BOARD_PORT_C] == 0x06);
+    CHECK(batch.clear[BOARD_PORT_C] == 0x09);
+    CHECK((batch.set[BOARD_PORT_C] & batch.clear[BOARD_PORT_C]) == 0);
+    CHECK(batch.set[BOARD_PORT_A] == 0 && batch.clear[BOARD_PORT_A] == 0);
+}
+
+// One PCOR and one PSOR per port that has bits to change, counted with
+// interrupts masked and restored.
+static void test_commit(void) {
+    PortOutBatch batch = PORTOUT_BATCH_INIT;
+    portout_stage(&batch, BOARD_PORT_C, MOTOR_PINS, LEFT_IN);
+    portout_stage(&batch, BOARD_PORT_A, 0x02, 0x02);
+    PTA->PCOR = PTB->PSOR = PTB->PCOR = 0xDEAD;
+    uint32_t writes = portout_stats.writes;
+    portout_commit(&batch);
+    CHECK(PTC->PCOR == (MOTOR_PINS & ~LEFT_IN) && PTC->PSOR == LEFT_IN);
+    CHECK(PTA->PSOR == 0x02 && PTA->PCOR == 0xDEAD);
+    CHECK(PTB->PSOR == 0xDEAD && PTB->PCOR == 0xDEAD);
+    CHECK(portout_stats.writes - writes == 3 && portout_stats.commits == 1);
+    CHECK(__get_PRIMASK() == 0);
+}
+
+// The two inputs of one side: 00 coast, 01/10 drive, 11 brake.
+static uint32_t side(uint32_t pins, uint32_t in, uint32_t out) {
+    return ((pins & in) ? 2U : 0U) | ((pins & out) ? 1U : 0U);
+}
+
+static bool side_ok(uint32_t between, uint32_t from, uint32_t to, uint32_t in, uint32_t out) {
+    uint32_t s = side(between, in, out);
+    return s == side(from, in, out) || s == side(to, in, out) || s == 0;
+}
+
+// Clears go first, so between the two writes a side is in its old state, its
+// new one or coasting: never a brake or a direction neither state asked for.
+// A move costs 1.8 writes on average (stop only sets).
+static void test_transitions(void) {
+    uint32_t writes = 0;
+    uint32_t moves = 0;
+    for (int a = 0; a < 5; a++) {
+        for (int b = 0; b < 5; b++) {
+            uint32_t from = motor_states[a], to = motor_states[b];
+            PortOutBatch batch = PORTOUT_BATCH_INIT;
+            portout_stage(&batch, BOARD_PORT_C, MOTOR_PINS, to);
+            uint32_t between = from & ~batch.clear[BOARD_PORT_C];
+            uint32_t after = between | batch.set[BOARD_PORT_C];
+            CHECK(after == to);
+            CHECK(side_ok(between, from, to, LEFT_IN, LEFT_OUT));
+            CHECK(side_ok(between, from, to, RIGHT_IN, RIGHT_OUT));
+
+            uint32_t before = portout_stats.writes;
+            portout_commit(&batch);
+            writes += portout_stats.writes - before;
+            moves++;
+        }
+    }
+    printf("portout: %u writes for %u motor moves\n", (unsigned)writes, (unsigned)moves);
+    CHECK(writes * 10U == moves * 18U);
+}
+
+int main(void) {
+    test_stage();
+    test_commit();
+    test_transitions();
+    return TEST_EXIT();
+}
@@ -0,0 +1,137 @@
+// test_powermon.c
+// Block filter, stall cut and step compensation of powermon.c, fed with
+// synthetic ADC blocks one block time (1.5 ms) apart.
+#include <stdbool.h>
+#include "test.h"
+#include "MKL25Z4.h"
+#include "motor.h"
+#include "powermon.h"
+
+#define BLOCK_US 1500U
+
+static uint32_t now_us;
+static int8_t   duty[2];
+static uint32_t cut_at_us[2];
+
+uint32_t timebase_now_us(void) { return now_us; }
+
+void motor_get_duty(int8_t *left, int8_t *right) {
+    *left = duty[MOTOR_LEFT];
+    *right = duty[MOTOR_RIGHT];
+}
+
+void motor_cut_side(MotorSide side) {
+    duty[side] = 0;
+    cut_at_us[side] = now_us;
+}
+
+static uint16_t raw(uint32_t value, uint32_t full_scale) {
+    uint32_t r = (value * 65536U + full_scale / 2) / full_scale;
+    return (uint16_t)((r > 0xFFFFU) ? 0xFFFFU : r);
+}
+
+// One block with every round at the given battery voltage and currents.
+static void feed(uint32_t battery_mv, uint32_t left_ma, uint32_t right_ma) {
+    uint16_t block[POWERMON_SLOTS];
+    for (uint32_t slot = 0; slot < POWERMON_SLOTS; slot += POWERMON_INPUTS) {
+        block[slot + POWERMON_BATTERY] = raw(battery_mv, POWERMON_BATTERY_FS_MV);
+        block[slot + POWERMON_LEFT] = raw(left_ma, POWERMON_CURRENT_FS_MA);
+        block[slot + POWERMON_RIGHT] = raw(right_ma, POWERMON_CURRENT_FS_MA);
+    }
+    now_us += BLOCK_US;
+    powermon_process_block(block);
+}
+
+static void settle(uint32_t battery_mv) {
+    duty[MOTOR_LEFT] = duty[MOTOR_RIGHT] = 0;
+    for (int i = 0; i < 200; i++) {
+        feed(battery_mv, 300, 300);
+    }
+}
+
+static void test_filter(void) {
+    uint32_t state = 0;
+    uint16_t out = 0;
+    for (int i = 0; i < 300; i++) {
+        out = powermon_filter(&state, 1000, 4);
+    }
+    CHECK(out >= 999 && out <= 1000);
+    state = 0;
+    out = powermon_filter(&state, 1000, 1);
+    CHECK(out == 500); // Half way per block at shift 1
+    out = powermon_filter(&state, 1, 1);
+    CHECK(out == 250);
+}
+
+// A stalled left side is cut POWERMON_STALL_MS after the current rises, plus
+// at most the filter's lag; the right side keeps running.
+static void test_stall(void) {
+    settle(POWERMON_NOMINAL_MV);
+    duty[MOTOR_LEFT] = duty[MOTOR_RIGHT] = 100;
+    cut_at_us[MOTOR_LEFT] = cut_at_us[MOTOR_RIGHT] = 0;
+    uint32_t cuts = powermon_stats.stall_cuts[MOTOR_LEFT];
+    uint32_t start = now_us;
+    for (int i = 0; i < 100 && duty[MOTOR_LEFT] != 0; i++) {
+        feed(POWERMON_NOMINAL_MV, 2500, 600);
+    }
+    uint32_t to_cut = cut_at_us[MOTOR_LEFT] - start;
+    printf("powermon: %u mA stall cut after %u us (POWERMON_STALL_MS %u)\n",
+           2500U, (unsigned)to_cut, POWERMON_STALL_MS);
+    CHECK(duty[MOTOR_LEFT] == 0 && duty[MOTOR_RIGHT] == 100);
+    CHECK(to_cut >= POWERMON_STALL_MS * 1000U);
+    CHECK(to_cut <= POWERMON_STALL_MS * 1000U + 3 * BLOCK_US);
+    CHECK(powermon_stats.stall_cuts[MOTOR_LEFT] == cuts + 1);
+    CHECK(powermon_stats.current_ma[MOTOR_LEFT] >= 2490 && powermon_stats.current_ma[MOTOR_LEFT] <= 2500);
+}
+
+// Start-up inrush: twice the stall threshold for 15 ms, then the running
+// current. It never lasts POWERMON_STALL_MS, so neither side is cut.
+static void test_inrush(void) {
+    settle(POWERMON_NOMINAL_MV);
+    duty[MOTOR_LEFT] = duty[MOTOR_RIGHT] = 100;
+    for (uint32_t t = 0; t < 200000; t += BLOCK_US) {
+        uint32_t ma = (t < 15000) ? 2 * POWERMON_STALL_MA : 700;
+        feed(POWERMON_NOMINAL_MV, ma, ma);
+    }
+    CHECK(duty[MOTOR_LEFT] == 100 && duty[MOTOR_RIGHT] == 100);
+
+    // A side that is not driven is never cut, whatever the reading.
+    duty[MOTOR_LEFT] = 0;
+    for (int i = 0; i < 50; i++) {
+        feed(POWERMON_NOMINAL_MV, 3000, 700);
+    }
+    CHECK(duty[MOTOR_RIGHT] == 100 && cut_at_us[MOTOR_LEFT] != now_us);
+}
+
+// Step time scales with nominal / battery, capped at twice nominal.
+static void test_step_scaling(void) {
+    static const struct { uint32_t mv, step_ms; } cases[] = {
+        { 8400, 500 },   // Above nominal: no shortening
+        { 7200, 500 },
+        { 6000, 600 },
+        { 4800, 750 },
+        { 3700, 973 },
+        { 3600, 1000 },  // Half of nominal and below: the cap
+        { 3000, 1000 },
+    };
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        settle(cases[i].mv);
+        uint32_t mv = powermon_stats.battery_mv;
+        CHECK(mv + 5 >= cases[i].mv && mv <= cases[i].mv + 5);
+        uint32_t step = powermon_step_ms(500);
+        if (step + 3 < cases[i].step_ms || step > cases[i].step_ms + 3 || step > 1000) {
+            printf("powermon: %u mV -> %u ms, expected %u\n",
+                   (unsigned)cases[i].mv, (unsigned)step, (unsigned)cases[i].step_ms);
+            CHECK(0);
+        }
+    }
+}
+
+int main(void) {
+    CHECK(powermon_step_ms(500) == 500); // No block yet
+    test_filter();
+    test_stall();
+    test_inrush();
+    test_step_scaling();
+    return TEST_EXIT();
+}
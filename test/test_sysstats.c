@@ -0,0 +1,142 @@
+// test_sysstats.c
+// Per-thread CPU accounting of sysstats.c, driven by a simulated scheduler: a
+// fake system timer (wrapping during the run) advances by a random slice per
+// thread and the switch hook is called at every switch, as RTX does.
+#include <stdlib.h>
+#include "test.h"
+#include "sysstats.h"
+
+#define STACK_SIZE 512U
+#define SLICES     20000
+#define WORKERS    3
+
+static uint32_t sys_now = 0xFFF00000U;
+static osThreadId_t running;
+static uint32_t stack_space[SYSSTATS_MAX_THREADS + 1];
+static int timers;
+
+// Thread ids are the addresses of these; the last is never registered, like
+// the RTX timer thread.
+static char thread_obj[WORKERS + 2];
+#define WORKER(i)  ((osThreadId_t)&thread_obj[i])
+#define IDLE       ((osThreadId_t)&thread_obj[WORKERS])
+#define UNLISTED   ((osThreadId_t)&thread_obj[WORKERS + 1])
+
+uint32_t osKernelGetSysTimerCount(void) { return sys_now; }
+int32_t osKernelLock(void) { return 0; }
+int32_t osKernelRestoreLock(int32_t lock) { return lock; }
+osThreadId_t osThreadGetId(void) { return running; }
+uint32_t osThreadGetStackSize(osThreadId_t id) { return STACK_SIZE; }
+uint32_t osThreadGetStackSpace(osThreadId_t id) { return stack_space[(char *)id - thread_obj]; }
+osTimerId_t osTimerNew(osTimerFunc_t func, osTimerType_t type, void *arg, const osTimerAttr_t *attr) {
+    timers++;
+    return &timers;
+}
+osStatus_t osTimerStart(osTimerId_t timer, uint32_t ticks) { return osOK; }
+
+// Expected time per thread index (UNLISTED and the startup context in 'other').
+static uint64_t expected[WORKERS + 1];
+static uint64_t other;
+static uint32_t switches[WORKERS + 1];
+
+// Runs 'slices' random slices, ending with a switch so every cycle is booked.
+static void run(int slices, uint32_t max_slice) {
+    for (int s = 0; s < slices; s++) {
+        int next = rand() % (WORKERS + 2);
+        running = (osThreadId_t)&thread_obj[next];
+        sysstats_thread_switched(running);
+        uint32_t slice = 1U + (uint32_t)rand() % max_slice;
+        sys_now += slice;
+        if (next <= WORKERS) {
+            expected[next] += slice;
+            switches[next]++;
+        } else {
+            other += slice;
+        }
+    }
+    running = UNLISTED;
+    sysstats_thread_switched(running);
+}
+
+static void test_accounting(void) {
+    uint32_t start = sys_now;
+    sysstats_init();
+    CHECK(timers == 1);
+    running = NULL; // main() before the kernel starts
+    for (int i = 0; i < WORKERS; i++) {
+        CHECK(sysstats_register(WORKER(i), "worker") == i);
+        stack_space[i] = STACK_SIZE;
+    }
+    CHECK(sysstats_register(WORKER(0), "again") == 0);
+    sys_now += 1000;
+    other += 1000;
+    running = IDLE;
+    sysstats_thread_switched(IDLE);
+    CHECK(sysstats_register_idle() == WORKERS);
+    stack_space[WORKERS] = STACK_SIZE;
+
+    run(SLICES, 5000);
+    uint64_t total = other;
+    for (int i = 0; i <= WORKERS; i++) {
+        SysStatsThread t;
+        sysstats_get_thread(i, &t);
+        CHECK(t.cpu_cycles == expected[i]);
+        CHECK(t.switches_in == switches[i]);
+        total += t.cpu_cycles;
+    }
+    CHECK(total == (uint32_t)(sys_now - start)); // Across the timer wrap
+
+    // One window: shares of the cycles since init.
+    stack_space[1] = STACK_SIZE / 10;
+    sysstats_sample();
+    SysStatsReport r;
+    sysstats_get_report(&r);
+    CHECK(r.num_threads == WORKERS + 1 && r.window_cycles == total);
+    uint32_t sum = 0;
+    for (int i = 0; i <= WORKERS; i++) {
+        CHECK(r.cpu_permille[i] == expected[i] * 1000U / total);
+        CHECK(r.switches[i] == switches[i]);
+        sum += r.cpu_permille[i];
+    }
+    CHECK(r.idle_permille == r.cpu_permille[WORKERS]);
+    CHECK(sum + other * 1000U / total <= 1000 && sum + other * 1000U / total >= 1000 - WORKERS - 1);
+    CHECK(r.stack_low == (1U << 1) && r.stack_min_free[1] == STACK_SIZE / 10);
+    printf("sysstats: %d switches, idle %u permille, window %u cycles\n",
+           SLICES, (unsigned)r.idle_permille, (unsigned)r.window_cycles);
+
+    // The next window only covers what ran since: the idle thread alone here.
+    // The stack mark keeps its low point.
+    stack_space[1] = STACK_SIZE;
+    running = IDLE;
+    sysstats_thread_switched(IDLE);
+    sys_now += 40000;
+    running = UNLISTED;
+    sysstats_thread_switched(UNLISTED);
+    sys_now += 10000;
+    running = IDLE;
+    sysstats_thread_switched(IDLE);
+    sysstats_sample();
+    sysstats_get_report(&r);
+    CHECK(r.window_cycles == 50000);
+    CHECK(r.idle_permille == 800 && r.cpu_permille[0] == 0);
+    CHECK(r.switches[WORKERS] == 2 && r.switches[0] == 0);
+    CHECK(r.stack_min_free[1] == STACK_SIZE / 10);
+}
+
+static void test_full(void) {
+    static char extra[SYSSTATS_MAX_THREADS];
+    int slot = 0;
+    for (int i = 0; i < SYSSTATS_MAX_THREADS; i++) {
+        slot = sysstats_register((osThreadId_t)&extra[i], "extra");
+    }
+    CHECK(slot == -1);
+    CHECK(sysstats_register(NULL, "none") == -1);
+    CHECK(sysstats_slot_of(WORKER(2)) == 2 && sysstats_slot_of(UNLISTED) == -1);
+}
+
+int main(void) {
+    srand(1);
+    test_accounting();
+    test_full();
+    return TEST_EXIT();
+}
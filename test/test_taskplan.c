@@ -0,0 +1,63 @@
+// test_taskplan.c
+// Response-time analysis against hand-worked task sets, and the shipped plan.
+#include "test.h"
+#include "taskplan.h"
+
+// C/T = 1/4, 2/6, 3/12 by falling priority: R = 1, 3, 10.
+static void test_textbook_set(void) {
+    TaskPlanEntry plan[3] = {
+        { "a", osPriorityHigh,        4, 1, 0, 0 },
+        { "b", osPriorityAboveNormal, 6, 2, 0, 0 },
+        { "c", osPriorityNormal,     12, 3, 0, 0 },
+    };
+    uint32_t response[3];
+    CHECK(taskplan_schedulable(plan, 3, response));
+    CHECK(response[0] == 1);
+    CHECK(response[1] == 3);
+    CHECK(response[2] == 10);
+
+    // A lower-priority critical section of 2 blocks both higher tasks once.
+    plan[2].critical_us = 2;
+    CHECK(taskplan_schedulable(plan, 3, response));
+    CHECK(response[0] == 3);
+    CHECK(response[1] == 6);
+    CHECK(response[2] == 10);
+
+    // One more unit for the lowest task pushes it past its period.
+    plan[2].critical_us = 0;
+    plan[2].budget_us = 6;
+    CHECK(!taskplan_schedulable(plan, 3, response));
+    CHECK(response[2] > 12);
+    CHECK(response[0] == 1 && response[1] == 3);
+}
+
+// Equal priorities interfere with each other (round-robin).
+static void test_equal_priorities(void) {
+    TaskPlanEntry plan[2] = {
+        { "a", osPriorityNormal, 10, 4, 0, 0 },
+        { "b", osPriorityNormal, 10, 4, 0, 0 },
+    };
+    uint32_t response[2];
+    CHECK(taskplan_schedulable(plan, 2, response));
+    CHECK(response[0] == 8 && response[1] == 8);
+    plan[1].budget_us = 7;
+    CHECK(!taskplan_schedulable(plan, 2, NULL));
+}
+
+// main() refuses to start an unschedulable plan: the shipped one must pass.
+static void test_shipped_plan(void) {
+    uint32_t response[TASK_COUNT];
+    CHECK(taskplan_schedulable(task_plan, TASK_COUNT, response));
+    for (uint32_t i = 0; i < TASK_COUNT; i++) {
+        printf("taskplan: %-8s R = %6u us of %7u\n", task_plan[i].name,
+               (unsigned)response[i], (unsigned)task_plan[i].period_us);
+        CHECK(task_plan[i].stack_size % 8U == 0);
+    }
+}
+
+int main(void) {
+    test_textbook_set();
+    test_equal_priorities();
+    test_shipped_plan();
+    return TEST_EXIT();
+}
@@ -0,0 +1,129 @@
+// test_timebase.c
+// timebase_wait_until_us() against a fake TPM2 counter and kernel tick. Every
+// counter read costs SPIN_STEP_US, the thread resumes up to WAKE_LATENCY_US
+// after a tick, and it is sometimes preempted while spinning. The wait must
+// end on time whatever the tick phase, and spin for less than a tick.
+#include <stdbool.h>
+#include <stdlib.h>
+#include "test.h"
+#include "MKL25Z4.h"
+#include "cmsis_os2.h"
+#include "timebase.h"
+
+#define SPIN_STEP_US    2
+#define WAKE_LATENCY_US 300
+#define PREEMPT_MAX_US  400
+
+void TPM2_IRQHandler(void);
+
+SIM_Type SIM_s;
+OSC_Type OSC0_s;
+TPM_Type TPM2_s;
+
+static uint32_t now;            // True time, us
+static uint32_t primask;
+static uint32_t tick_phase;     // Ticks fall on now % 1000 == tick_phase
+static uint32_t last_resume;    // Latest time the thread got the CPU back
+static uint32_t spun_us;
+static uint32_t delays;
+static bool     kernel_running = true;
+static bool     preempt = true;
+
+static void advance(uint32_t us) {
+    uint32_t before = now;
+    now += us;
+    TPM2->CNT = now & 0xFFFF;
+    if ((now >> 16) != (before >> 16)) {
+        TPM2->SC |= TPM_SC_TOF_MASK;
+    }
+    if (primask == 0 && (TPM2->SC & TPM_SC_TOF_MASK)) {
+        TPM2_IRQHandler();
+        TPM2->SC &= ~TPM_SC_TOF_MASK; // Write-1-to-clear on the chip
+    }
+}
+
+uint32_t __get_PRIMASK(void) { return primask; }
+void     __disable_irq(void) { primask = 1; }
+uint32_t __get_IPSR(void)    { return 0; }
+void     NVIC_EnableIRQ(IRQn_Type irq)       {}
+void     NVIC_ClearPendingIRQ(IRQn_Type irq) {}
+
+// Restored at the end of every timebase_now_us(): one spin of the caller.
+void __set_PRIMASK(uint32_t v) {
+    primask = v;
+    spun_us += SPIN_STEP_US;
+    advance(SPIN_STEP_US);
+    if (preempt && rand() % 100 == 0) {
+        advance(1 + (uint32_t)rand() % PREEMPT_MAX_US);
+        last_resume = now;
+    }
+}
+
+osKernelState_t osKernelGetState(void) {
+    return kernel_running ? osKernelRunning : osKernelInactive;
+}
+
+// Returns on the n-th tick from now, plus the time until the thread runs.
+osStatus_t osDelay(uint32_t ticks) {
+    CHECK(ticks != 0);
+    delays++;
+    uint32_t to_tick = TIMEBASE_TICK_US - (now - tick_phase) % TIMEBASE_TICK_US;
+    advance(to_tick + (ticks - 1) * TIMEBASE_TICK_US);
+    advance((uint32_t)rand() % (WAKE_LATENCY_US + 1));
+    last_resume = now;
+    return osOK;
+}
+
+static void test_wait(void) {
+    uint32_t max_spin = 0, max_late = 0, max_slept_late = 0;
+    for (int i = 0; i < 5000; i++) {
+        tick_phase = (uint32_t)rand() % TIMEBASE_TICK_US; // Tickless idle re-phases the tick
+        uint32_t deadline = timebase_now_us() + (uint32_t)rand() % 20000;
+        spun_us = 0;
+        last_resume = now;
+        timebase_wait_until_us(deadline);
+
+        // Late only by the time the thread had no CPU, plus a few reads.
+        int32_t late = (int32_t)(now - deadline);
+        uint32_t ready = ((int32_t)(last_resume - deadline) > 0) ? last_resume : deadline;
+        CHECK(late >= 0);
+        CHECK(now - ready <= 2 * SPIN_STEP_US);
+        if ((uint32_t)late > max_late) {
+            max_late = (uint32_t)late;
+        }
+        if (now - ready > max_slept_late) {
+            max_slept_late = now - ready;
+        }
+        if (spun_us > max_spin) {
+            max_spin = spun_us;
+        }
+        uint32_t t = now;
+        CHECK(timebase_now_us() == t); // Tracks true time across 16-bit wraps
+    }
+    CHECK(max_spin < TIMEBASE_TICK_US);
+    printf("timebase: 5000 waits up to 20 ms, max spin %u us, max %u us past deadline or resume "
+           "(%u us past deadline, preempted)\n",
+           (unsigned)max_spin, (unsigned)max_slept_late, (unsigned)max_late);
+}
+
+// Before the kernel runs a wait only spins.
+static void test_no_kernel(void) {
+    kernel_running = false;
+    preempt = false;
+    delays = 0;
+    uint32_t deadline = timebase_now_us() + 5000;
+    timebase_wait_until_us(deadline);
+    CHECK(delays == 0);
+    CHECK(now - deadline <= 2 * SPIN_STEP_US);
+    kernel_running = true;
+    preempt = true;
+}
+
+int main(void) {
+    srand(1);
+    timebase_init();
+    TPM2->SC &= ~TPM_SC_TOF_MASK; // Cleared by the write of 1 in timebase_init()
+    test_wait();
+    test_no_kernel();
+    return TEST_EXIT();
+}
@@ -0,0 +1,171 @@
+// test_wavetrace.c
+// Capture, VCD export and timing compare of the pin waveform trace, with a
+// fake timebase, and the framed VCD dump through a fake UART.
+#include <string.h>
+#include "test.h"
+#include "MKL25Z4.h"
+#include "cmsis_os2.h"
+#include "cobs.h"
+#include "telemetry.h"
+#include "wavetrace.h"
+
+static uint32_t now_us;
+static uint8_t  sent[8192];
+static size_t   sent_len;
+static int      refuse;      // uart_tx_dma() calls to refuse, as if telemetry had the link
+
+uint32_t timebase_now_us(void) { return now_us; }
+bool uart_tx_busy(void)        { return false; }
+osStatus_t osDelay(uint32_t ticks) { return osOK; }
+
+bool uart_tx_dma(const uint8_t *data, uint32_t len) {
+    if (refuse > 0) {
+        refuse--;
+        return false;
+    }
+    CHECK(sent_len + len <= sizeof(sent));
+    memcpy(sent + sent_len, data, len);
+    sent_len += len;
+    return true;
+}
+
+// A red LED blinking 'flashes' times with the given half period, from t0.
+static void capture_blink(WaveTrace *out, uint32_t half_period_us, int flashes) {
+    now_us = 5000;
+    wavetrace_set(WAVE_LEDS, 0);
+    wavetrace_start();
+    for (int i = 0; i < flashes; i++) {
+        now_us += half_period_us;
+        wavetrace_set_bit(WAVE_LEDS, 8, true);
+        now_us += half_period_us;
+        wavetrace_set_bit(WAVE_LEDS, 8, false);
+    }
+    wavetrace_stop();
+    *out = wavetrace;
+}
+
+static WaveTrace ref, run;
+static const WaveTolerance tol[WAVE_SIGNALS] = {
+    [WAVE_LEDS]      = { 200, 50 },  // 5%
+    [WAVE_MOTOR]     = { 200, 50 },
+    [WAVE_BUZZER_HZ] = { 200, 50 },
+};
+
+static void test_capture(void) {
+    capture_blink(&ref, 100000, 4);
+    CHECK(ref.count == 8 && ref.dropped == 0);
+    CHECK(ref.events[0].t_us == 100000 && ref.events[0].value == 0x0100);
+    CHECK(ref.events[1].t_us == 200000 && ref.events[1].value == 0);
+    CHECK(__get_PRIMASK() == 0);
+
+    // Setting a value it already has is not a change.
+    wavetrace_start();
+    wavetrace_set(WAVE_MOTOR, 0);
+    CHECK(wavetrace.count == 0);
+    wavetrace_stop();
+}
+
+// 3% slower passes a 5% tolerance, 10% slower fails on the first interval.
+static void test_compare(void) {
+    WaveDiff diff;
+    capture_blink(&ref, 100000, 4);
+    CHECK(wavetrace_compare(&ref, &ref, tol, &diff));
+
+    capture_blink(&run, 103000, 4);
+    CHECK(wavetrace_compare(&ref, &run, tol, &diff));
+
+    capture_blink(&run, 110000, 4);
+    CHECK(!wavetrace_compare(&ref, &run, tol, &diff));
+    CHECK(diff.signal == WAVE_LEDS && !diff.value_differs && diff.change == 1);
+    CHECK(diff.ref_us == 100000 && diff.run_us == 110000);
+
+    // One flash fewer is a change-count difference.
+    capture_blink(&run, 100000, 3);
+    CHECK(!wavetrace_compare(&ref, &run, tol, &diff));
+    CHECK(diff.value_differs && diff.ref_us == 1 && diff.run_us == 0);
+}
+
+static void test_overflow(void) {
+    capture_blink(&run, 10, WAVETRACE_EVENTS / 2 + 5);
+    CHECK(run.count == WAVETRACE_EVENTS && run.dropped == 10);
+}
+
+static char vcd[4096];
+static size_t vcd_len;
+
+static void emit(const char *line, size_t len) {
+    CHECK(vcd_len + len < sizeof(vcd));
+    memcpy(vcd + vcd_len, line, len);
+    vcd_len += len;
+}
+
+static void test_vcd(void) {
+    capture_blink(&ref, 100000, 1);
+    vcd_len = 0;
+    wavetrace_write_vcd(&ref, emit);
+    vcd[vcd_len] = '\0';
+    CHECK(strncmp(vcd, "$timescale 1us $end\n", 20) == 0);
+    CHECK(strstr(vcd, "$var wire 16 ! leds $end\n") != NULL);
+    CHECK(strstr(vcd, "$var wire 4 \" motor $end\n") != NULL);
+    CHECK(strstr(vcd, "$enddefinitions $end\n#0\n") != NULL);
+    CHECK(strstr(vcd, "#100000\nb0000000100000000 !\n#200000\nb0000000000000000 !\n") != NULL);
+    CHECK(vcd[vcd_len - 1] == '\n');
+}
+
+static size_t cobs_decode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t i = 0, o = 0;
+    while (i < len) {
+        uint8_t code = in[i++];
+        for (uint8_t j = 1; j < code && i < len; j++) {
+            out[o++] = in[i++];
+        }
+        if (code < 0xFF && i < len) {
+            out[o++] = 0;
+        }
+    }
+    return o;
+}
+
+// The dump is a run of COBS frames with no raw text between them; their
+// payloads, in offset order, are the file wavetrace_write_vcd() produces.
+static void test_dump(void) {
+    static char file[4096];
+    capture_blink(&ref, 100000, 8);
+    vcd_len = 0;
+    wavetrace_write_vcd(&wavetrace, emit);
+
+    sent_len = 0;
+    refuse = 3;
+    wavetrace_dump_uart();
+    CHECK(refuse == 0);
+
+    size_t file_len = 0, start = 0;
+    int packets = 0;
+    for (size_t i = 0; i < sent_len; i++) {
+        if (sent[i] != 0x00) {
+            continue;
+        }
+        uint8_t packet[3 + WAVETRACE_DUMP_CHUNK + 1];
+        CHECK(i - start <= COBS_MAX_ENCODED(3 + WAVETRACE_DUMP_CHUNK));
+        size_t n = cobs_decode(&sent[start], i - start, packet);
+        CHECK(n > 3 && n <= 3 + WAVETRACE_DUMP_CHUNK);
+        CHECK(packet[0] == TELEMETRY_TYPE_WAVETRACE);
+        CHECK((size_t)(packet[1] | (packet[2] << 8)) == file_len);
+        memcpy(file + file_len, &packet[3], n - 3);
+        file_len += n - 3;
+        packets++;
+        start = i + 1;
+    }
+    CHECK(start == sent_len);   // Ends on a delimiter
+    CHECK(file_len == vcd_len && memcmp(file, vcd, vcd_len) == 0);
+    CHECK(packets == (int)((vcd_len + WAVETRACE_DUMP_CHUNK - 1) / WAVETRACE_DUMP_CHUNK));
+}
+
+int main(void) {
+    test_capture();
+    test_compare();
+    test_overflow();
+    test_vcd();
+    test_dump();
+    return TEST_EXIT();
+}
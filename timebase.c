@@ -0,0 +1,112 @@
+// timebase.c
+#include "timebase.h"
+#include "MKL25Z4.h"
+#include "cmsis_os2.h"
+#include <stdbool.h>
+
+#define TIMEBASE_TPM TPM2
+#define ALARM_CH     1
+#define CAPTURE_CH   0
+
+// Upper 16 bits of the 32-bit microsecond count.
+static volatile uint32_t overflows = 0;
+static TimebaseCaptureHandler capture_handler = NULL;
+
+void timebase_init(void) {
+    // OSCERCLK must stay enabled (and enabled in stop modes) to clock the TPMs.
+    OSC0->CR |= OSC_CR_ERCLKEN_MASK | OSC_CR_EREFSTEN_MASK;
+
+    // Enable clock gating for Timer 2.
+    SIM->SCGC6 |= SIM_SCGC6_TPM2_MASK;
+
+    // Select clock source: OSCERCLK (8 MHz).
+    SIM->SOPT2 &= ~SIM_SOPT2_TPMSRC_MASK;
+    SIM->SOPT2 |= SIM_SOPT2_TPMSRC(2);
+
+    // Free-running up-counter: full 16-bit range, prescaler /8 -> 1 MHz.
+    TIMEBASE_TPM->SC = 0;
+    TIMEBASE_TPM->CNT = 0;
+    TIMEBASE_TPM->MOD = 0xFFFF;
+    TIMEBASE_TPM->SC = TPM_SC_TOF_MASK | TPM_SC_TOIE_MASK | TPM_SC_PS(3);
+    TIMEBASE_TPM->SC |= TPM_SC_CMOD(1);
+
+    NVIC_ClearPendingIRQ(TPM2_IRQn);
+    NVIC_EnableIRQ(TPM2_IRQn);
+}
+
+void TPM2_IRQHandler(void) {
+    if (TIMEBASE_TPM->SC & TPM_SC_TOF_MASK) {
+        TIMEBASE_TPM->SC |= TPM_SC_TOF_MASK; // Write 1 to clear
+        overflows++;
+    }
+    if (TIMEBASE_TPM->CONTROLS[CAPTURE_CH].CnSC & TPM_CnSC_CHF_MASK) {
+        uint16_t edge = (uint16_t)TIMEBASE_TPM->CONTROLS[CAPTURE_CH].CnV;
+        TIMEBASE_TPM->CONTROLS[CAPTURE_CH].CnSC |= TPM_CnSC_CHF_MASK;
+        if (capture_handler != NULL) {
+            capture_handler(edge);
+        }
+    }
+    if (TIMEBASE_TPM->CONTROLS[ALARM_CH].CnSC & TPM_CnSC_CHF_MASK) {
+        // One-shot: the wake-up itself is all the alarm is for.
+        TIMEBASE_TPM->CONTROLS[ALARM_CH].CnSC = TPM_CnSC_CHF_MASK;
+    }
+}
+
+void timebase_set_alarm_us(uint32_t at_us) {
+    // Software compare mode (MSA, no pin output) with the channel interrupt.
+    TIMEBASE_TPM->CONTROLS[ALARM_CH].CnSC = TPM_CnSC_CHF_MASK;
+    TIMEBASE_TPM->CONTROLS[ALARM_CH].CnV = at_us & 0xFFFF;
+    TIMEBASE_TPM->CONTROLS[ALARM_CH].CnSC = TPM_CnSC_MSA_MASK | TPM_CnSC_CHIE_MASK;
+}
+
+void timebase_cancel_alarm(void) {
+    TIMEBASE_TPM->CONTROLS[ALARM_CH].CnSC = TPM_CnSC_CHF_MASK;
+}
+
+void timebase_capture_init(TimebaseCaptureHandler handler) {
+    capture_handler = handler;
+    // Input capture on rising and falling edges (ELSB:ELSA = 11).
+    TIMEBASE_TPM->CONTROLS[CAPTURE_CH].CnSC = TPM_CnSC_CHF_MASK;
+    TIMEBASE_TPM->CONTROLS[CAPTURE_CH].CnSC = TPM_CnSC_ELSA_MASK | TPM_CnSC_ELSB_MASK |
+                                              TPM_CnSC_CHIE_MASK;
+}
+
+uint32_t timebase_now_us(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t high = overflows;
+    uint32_t low = TIMEBASE_TPM->CNT;
+    if (TIMEBASE_TPM->SC & TPM_SC_TOF_MASK) {
+        // Wrapped since the last interrupt was serviced: re-read so that
+        // 'low' is known to be after the wrap.
+        low = TIMEBASE_TPM->CNT;
+        high++;
+    }
+    __set_PRIMASK(primask);
+    return (high << 16) | (low & 0xFFFF);
+}
+
+uint32_t timebase_elapsed_us(uint32_t start_us) {
+    return timebase_now_us() - start_us;
+}
+
+void timebase_wait_until_us(uint32_t deadline_us) {
+    bool can_sleep = (osKernelGetState() == osKernelRunning) && (__get_IPSR() == 0);
+    for (;;) {
+        int32_t remaining = (int32_t)(deadline_us - timebase_now_us());
+        if (remaining <= 0) {
+            return;
+        }
+        if (can_sleep && remaining >= TIMEBASE_TICK_US) {
+            // osDelay(n) returns on the n-th tick interrupt, never later than n
+            // ticks from now. The first sleep may end anywhere in a tick; the
+            // thread then runs just after a tick, so the next one ends on the
+            // last tick before the deadline.
+            osDelay((uint32_t)remaining / TIMEBASE_TICK_US);
+        }
+    }
+}
+
+void timebase_delay_us(uint32_t us) {
+    timebase_wait_until_us(timebase_now_us() + us);
+}
@@ -0,0 +1,40 @@
+// timebase.h
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+
+// Microsecond timebase on TPM2.
+// TPM2 counts OSCERCLK (8 MHz crystal) / 8 = 1 MHz, free-running over 16 bits;
+// the overflow interrupt extends it to 32 bits, so timestamps wrap after ~71
+// minutes. Compare timestamps with unsigned subtraction. OSCERCLK stays on in
+// VLPS (EREFSTEN), so the count keeps running while the CPU sleeps.
+
+// --- Configuration ---
+#define TIMEBASE_TPM_CLOCK_HZ 1000000  // Shared by every TPM (SIM_SOPT2 TPMSRC is global)
+#define TIMEBASE_TICK_US      1000     // Kernel tick (1 kHz)
+
+// --- Function Prototypes ---
+void     timebase_init(void);                      // Call once at startup, before any wait
+uint32_t timebase_now_us(void);                    // Safe from threads and ISRs
+uint32_t timebase_elapsed_us(uint32_t start_us);   // Benchmark helper: now - start
+
+// Waits until the timebase reaches deadline_us. Sleeps with osDelay up to the
+// last kernel tick before the deadline and spins only for the part of a tick
+// that is left, so a wait spins for less than TIMEBASE_TICK_US. Outside a
+// running kernel (or in an ISR) it only spins.
+void     timebase_wait_until_us(uint32_t deadline_us);
+void     timebase_delay_us(uint32_t us);
+
+// One-shot interrupt on TPM2 channel 1 when the low 16 bits of the count reach
+// at_us. Only meant to wake the CPU: targets more than 65 ms away fire early,
+// and the overflow interrupt wakes it at least every 65.5 ms anyway.
+void     timebase_set_alarm_us(uint32_t at_us);
+void     timebase_cancel_alarm(void);
+
+// Input capture on TPM2 channel 0 (PTB2, ALT3), both edges. handler runs in
+// the TPM2 interrupt with the low 16 bits of the timebase at the edge.
+typedef void (*TimebaseCaptureHandler)(uint16_t edge_us);
+void     timebase_capture_init(TimebaseCaptureHandler handler);
+
+#endif // TIMEBASE_H
@@ -0,0 +1,115 @@
+// uart.c
+#include "config.h"
+
+#if FEATURE_LINK
+
+#include "uart.h"
+#include "MKL25Z4.h"
+#include "cmsis_os2.h"
+#include "timebase.h"
+
+static volatile uint8_t rx_storage[UART_RX_BUF_SIZE];
+RingBuf uart_rx = RINGBUF_INIT(rx_storage);
+
+volatile UartStats uart_stats;
+
+static osThreadId_t rx_thread = NULL;
+static volatile uint32_t last_rx_us = 0;
+
+void uart_init(void) {
+    // Enable clock gating for UART2. PTE22/PTE23 are muxed by board_init().
+    SIM->SCGC4 |= SIM_SCGC4_UART2_MASK;
+
+    // Transmitter and receiver off while the baud rate is changed.
+    UART2->C2 &= ~(UART_C2_TE_MASK | UART_C2_RE_MASK);
+
+    // Baud rate = bus clock / (16 * SBR).
+    uint32_t sbr = (UART_BUS_CLOCK_HZ + 8 * UART_BAUD_RATE) / (16 * UART_BAUD_RATE);
+    UART2->BDH = (UART2->BDH & ~UART_BDH_SBR_MASK) | UART_BDH_SBR(sbr >> 8);
+    UART2->BDL = UART_BDL_SBR(sbr);
+
+    // 8N1, no parity.
+    UART2->C1 = 0;
+    UART2->C3 = 0;
+
+    NVIC_SetPriority(UART2_IRQn, 1);
+    NVIC_ClearPendingIRQ(UART2_IRQn);
+    NVIC_EnableIRQ(UART2_IRQn);
+
+    // Transmit requests go to the DMA controller instead of the CPU.
+    SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+    SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+    DMAMUX0->CHCFG[UART_TX_DMA_CH] = 0;
+    DMAMUX0->CHCFG[UART_TX_DMA_CH] = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(UART_TX_DMA_SRC);
+    UART2->C4 |= UART_C4_TDMAS_MASK;
+
+    UART2->C2 |= UART_C2_TE_MASK | UART_C2_RE_MASK | UART_C2_RIE_MASK;
+}
+
+void uart_set_rx_thread(osThreadId_t thread) {
+    rx_thread = thread;
+}
+
+uint32_t uart_last_rx_us(void) {
+    return last_rx_us;
+}
+
+// --- DMA Transmit ---
+// One descriptor per buffer: the channel moves a byte to UART2->D on each
+// transmit request and D_REQ drops ERQ when the count reaches zero, so the
+// CPU is not involved again until the next buffer.
+// The DMA drops ERQ when it has handed over the last byte; that byte is still
+// in the shift register until TC sets.
+bool uart_tx_busy(void) {
+    return (DMA0->DMA[UART_TX_DMA_CH].DCR & DMA_DCR_ERQ_MASK) != 0 ||
+           (UART2->S1 & UART_S1_TC_MASK) == 0;
+}
+
+// Telemetry, the trace dumps and the benchmark share the link from threads of
+// different priority, so the busy check and the descriptor setup run with
+// interrupts off: a thread preempted between the two would otherwise rewrite
+// the channel under a transfer started by the thread that preempted it.
+bool uart_tx_dma(const uint8_t *buf, uint32_t len) {
+    if (len == 0) {
+        return false;
+    }
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (uart_tx_busy()) {
+        __set_PRIMASK(primask);
+        return false;
+    }
+    DMA0->DMA[UART_TX_DMA_CH].DSR_BCR = DMA_DSR_BCR_DONE_MASK; // Clear status of the last transfer
+    DMA0->DMA[UART_TX_DMA_CH].SAR = (uint32_t)buf;
+    DMA0->DMA[UART_TX_DMA_CH].DAR = (uint32_t)&UART2->D;
+    DMA0->DMA[UART_TX_DMA_CH].DSR_BCR = DMA_DSR_BCR_BCR(len);
+    DMA0->DMA[UART_TX_DMA_CH].DCR = DMA_DCR_ERQ_MASK | DMA_DCR_CS_MASK | DMA_DCR_SINC_MASK |
+                                    DMA_DCR_SSIZE(1) | DMA_DCR_DSIZE(1) | DMA_DCR_D_REQ_MASK;
+    UART2->C2 |= UART_C2_TIE_MASK; // With TDMAS set this raises DMA requests, not interrupts
+    __set_PRIMASK(primask);
+    return true;
+}
+
+// --- Receive ISR ---
+// Only moves the byte into the ring and wakes the decoder; all parsing happens
+// in thread context.
+void UART2_IRQHandler(void) {
+    uint8_t status = UART2->S1;
+
+    if (status & (UART_S1_OR_MASK | UART_S1_NF_MASK | UART_S1_FE_MASK | UART_S1_PF_MASK)) {
+        uart_stats.errors++;
+    }
+    if (status & (UART_S1_RDRF_MASK | UART_S1_OR_MASK)) {
+        uint8_t byte = UART2->D; // Reading D after S1 clears the flags
+        last_rx_us = timebase_now_us();
+        uart_stats.bytes++;
+        if (!ringbuf_put(&uart_rx, byte)) {
+            uart_stats.dropped++;
+        }
+        if (rx_thread != NULL) {
+            osThreadFlagsSet(rx_thread, UART_FLAG_RX);
+        }
+    }
+}
+
+#endif // FEATURE_LINK
@@ -0,0 +1,47 @@
+// uart.h
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmsis_os2.h"
+#include "ringbuf.h"
+
+// Serial link to the remote controller on UART2 (PTE22 = TX, PTE23 = RX).
+// UART0 stays free for the OpenSDA debug port. Receive is interrupt driven;
+// transmit is done by DMA channel 0 straight from the caller's buffer.
+
+// --- Configuration ---
+#define UART_BAUD_RATE    115200
+#define UART_BUS_CLOCK_HZ 24000000  // Bus clock with the 48 MHz core clock
+#define UART_RX_BUF_SIZE  128       // Power of two
+
+#define UART_FLAG_RX      0x0001U   // Thread flag raised on the receiving thread per byte
+#define UART_TX_DMA_CH    0
+#define UART_TX_DMA_SRC   7         // DMAMUX source: UART2 transmit
+
+// --- Receive Path ---
+// Filled by UART2_IRQHandler, drained by the command decoder.
+extern RingBuf uart_rx;
+
+typedef struct {
+    uint32_t bytes;
+    uint32_t dropped;      // Ring full
+    uint32_t errors;       // Overrun, noise, framing or parity
+} UartStats;
+
+extern volatile UartStats uart_stats;
+
+// --- Function Prototypes ---
+void     uart_init(void);
+void     uart_set_rx_thread(osThreadId_t thread); // Thread woken with UART_FLAG_RX
+uint32_t uart_last_rx_us(void);                   // Timebase stamp of the newest byte
+
+// Starts a DMA transfer of len bytes and returns at once. buf must stay
+// untouched until uart_tx_busy() is false. Returns false (and sends nothing)
+// while a previous transfer is still running; the check and the start are one
+// step, so threads sharing the link cannot both win it.
+bool     uart_tx_dma(const uint8_t *buf, uint32_t len);
+bool     uart_tx_busy(void);         // Until the last stop bit has left the pin
+
+#endif // UART_H
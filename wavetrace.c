@@ -0,0 +1,250 @@
+// wavetrace.c
+#include "wavetrace.h"
+
+#ifdef WAVETRACE
+
+#include <stdio.h>
+#include <string.h>
+#include "MKL25Z4.h"
+#include "cmsis_os2.h"
+#include "cobs.h"
+#include "telemetry.h"
+#include "timebase.h"
+#include "uart.h"
+
+WaveTrace wavetrace;
+
+static uint16_t current[WAVE_SIGNALS];  // Tracked even while not recording
+static bool     recording = false;
+static uint32_t start_us = 0;
+
+static const struct {
+    const char *name;
+    uint8_t     width;
+    char        id;        // VCD identifier
+} signal_info[WAVE_SIGNALS] = {
+    { "leds",      16, '!' },
+    { "motor",      4, '"' },
+    { "buzzer_hz", 16, '#' },
+};
+
+// --- Capture ---
+// Called from several threads, so the update is done with interrupts off.
+void wavetrace_set(WaveSignal signal, uint16_t value) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (current[signal] != value) {
+        current[signal] = value;
+        if (recording) {
+            if (wavetrace.count < WAVETRACE_EVENTS) {
+                WaveEvent *event = &wavetrace.events[wavetrace.count++];
+                event->t_us = timebase_now_us() - start_us;
+                event->value = value;
+                event->signal = (uint8_t)signal;
+                event->reserved = 0;
+            } else {
+                wavetrace.dropped++;
+            }
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+void wavetrace_set_bit(WaveSignal signal, uint32_t bit, bool on) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint16_t value = current[signal];
+    value = on ? (uint16_t)(value | (1U << bit)) : (uint16_t)(value & ~(1U << bit));
+    wavetrace_set(signal, value);
+    __set_PRIMASK(primask);
+}
+
+void wavetrace_start(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    wavetrace.count = 0;
+    wavetrace.dropped = 0;
+    for (int i = 0; i < WAVE_SIGNALS; i++) {
+        wavetrace.initial[i] = current[i];
+    }
+    start_us = timebase_now_us();
+    recording = true;
+    __set_PRIMASK(primask);
+}
+
+void wavetrace_stop(void) {
+    recording = false;
+}
+
+// --- VCD Export ---
+static int format_value(char *buf, size_t len, WaveSignal signal, uint16_t value) {
+    char bits[17];
+    uint8_t width = signal_info[signal].width;
+    for (uint8_t i = 0; i < width; i++) {
+        bits[i] = (value & (1U << (width - 1 - i))) ? '1' : '0';
+    }
+    bits[width] = '\0';
+    return snprintf(buf, len, "b%s %c\n", bits, signal_info[signal].id);
+}
+
+void wavetrace_write_vcd(const WaveTrace *trace, void (*emit)(const char *line, size_t len)) {
+    char line[48];
+    int n;
+
+    static const char header[] = "$timescale 1us $end\n$scope module robot $end\n";
+    static const char body[] = "$upscope $end\n$enddefinitions $end\n#0\n";
+
+    emit(header, sizeof(header) - 1);
+    for (int s = 0; s < WAVE_SIGNALS; s++) {
+        n = snprintf(line, sizeof(line), "$var wire %u %c %s $end\n",
+                     signal_info[s].width, signal_info[s].id, signal_info[s].name);
+        emit(line, (size_t)n);
+    }
+    emit(body, sizeof(body) - 1);
+    for (int s = 0; s < WAVE_SIGNALS; s++) {
+        n = format_value(line, sizeof(line), (WaveSignal)s, trace->initial[s]);
+        emit(line, (size_t)n);
+    }
+
+    uint32_t last_t = 0;
+    for (uint32_t i = 0; i < trace->count; i++) {
+        const WaveEvent *event = &trace->events[i];
+        if (event->t_us != last_t) {
+            n = snprintf(line, sizeof(line), "#%lu\n", (unsigned long)event->t_us);
+            emit(line, (size_t)n);
+            last_t = event->t_us;
+        }
+        n = format_value(line, sizeof(line), (WaveSignal)event->signal, event->value);
+        emit(line, (size_t)n);
+    }
+}
+
+// Sends the live capture over UART2 as telemetry packets of
+// TELEMETRY_TYPE_WAVETRACE, so the text cannot run into the status packets
+// telemetry keeps sending on the same line. One packet is encoded while the
+// DMA sends the other. Blocks (sleeping) until the whole file has gone out.
+static uint8_t  dump_chunk[3 + WAVETRACE_DUMP_CHUNK];
+static uint8_t  dump_packet[2][COBS_MAX_ENCODED(sizeof(dump_chunk)) + 1];
+static uint32_t dump_len = 0;     // Text bytes in dump_chunk
+static uint32_t dump_offset = 0;  // Of dump_chunk in the file
+static uint32_t dump_sel = 0;
+
+static void dump_flush(void) {
+    dump_chunk[0] = TELEMETRY_TYPE_WAVETRACE;
+    dump_chunk[1] = (uint8_t)dump_offset;
+    dump_chunk[2] = (uint8_t)(dump_offset >> 8);
+    uint32_t encoded = cobs_encode(dump_chunk, 3 + dump_len, dump_packet[dump_sel]);
+    dump_packet[dump_sel][encoded++] = 0x00;
+    while (!uart_tx_dma(dump_packet[dump_sel], encoded)) {
+        osDelay(1); // Previous packet, or telemetry got the link first
+    }
+    dump_sel ^= 1U;
+    dump_offset += dump_len;
+    dump_len = 0;
+}
+
+static void dump_emit(const char *line, size_t len) {
+    while (len != 0) {
+        size_t n = WAVETRACE_DUMP_CHUNK - dump_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(&dump_chunk[3 + dump_len], line, n);
+        dump_len += n;
+        line += n;
+        len -= n;
+        if (dump_len == WAVETRACE_DUMP_CHUNK) {
+            dump_flush();
+        }
+    }
+}
+
+void wavetrace_dump_uart(void) {
+    dump_len = 0;
+    dump_offset = 0;
+    wavetrace_write_vcd(&wavetrace, dump_emit);
+    if (dump_len != 0) {
+        dump_flush();
+    }
+    while (uart_tx_busy()) {
+        osDelay(1);
+    }
+}
+
+// --- Comparison ---
+// Finds the next change of 'signal' at or after *pos; returns false at the end.
+static bool next_change(const WaveTrace *trace, WaveSignal signal, uint32_t *pos) {
+    while (*pos < trace->count) {
+        if (trace->events[*pos].signal == signal) {
+            return true;
+        }
+        (*pos)++;
+    }
+    return false;
+}
+
+static bool compare_signal(const WaveTrace *ref, const WaveTrace *run, WaveSignal signal,
+                           const WaveTolerance *tol, WaveDiff *diff) {
+    uint32_t ref_pos = 0, run_pos = 0;
+    uint32_t ref_last = 0, run_last = 0;
+
+    diff->signal = signal;
+    diff->change = 0;
+    diff->value_differs = true;
+    if (ref->initial[signal] != run->initial[signal]) {
+        diff->ref_us = ref->initial[signal];
+        diff->run_us = run->initial[signal];
+        return false;
+    }
+    for (;;) {
+        bool ref_more = next_change(ref, signal, &ref_pos);
+        bool run_more = next_change(run, signal, &run_pos);
+        if (!ref_more || !run_more) {
+            if (ref_more == run_more) {
+                return true;
+            }
+            diff->ref_us = ref_more;   // Which one still had changes left
+            diff->run_us = run_more;
+            return false;
+        }
+        const WaveEvent *a = &ref->events[ref_pos++];
+        const WaveEvent *b = &run->events[run_pos++];
+        if (a->value != b->value) {
+            diff->ref_us = a->value;
+            diff->run_us = b->value;
+            return false;
+        }
+        uint32_t ref_interval = a->t_us - ref_last;
+        uint32_t run_interval = b->t_us - run_last;
+        ref_last = a->t_us;
+        run_last = b->t_us;
+        if (diff->change++ == 0) {
+            continue; // The first change only gives the phase against the capture start
+        }
+        uint32_t allowed = (uint32_t)(((uint64_t)ref_interval * tol->tol_permille) / 1000U);
+        if (allowed < tol->tol_us) {
+            allowed = tol->tol_us;
+        }
+        uint32_t delta = (run_interval > ref_interval) ? run_interval - ref_interval
+                                                       : ref_interval - run_interval;
+        if (delta > allowed) {
+            diff->ref_us = ref_interval;
+            diff->run_us = run_interval;
+            diff->change--;
+            diff->value_differs = false;
+            return false;
+        }
+    }
+}
+
+bool wavetrace_compare(const WaveTrace *ref, const WaveTrace *run,
+                       const WaveTolerance tol[WAVE_SIGNALS], WaveDiff *diff) {
+    for (int s = 0; s < WAVE_SIGNALS; s++) {
+        if (!compare_signal(ref, run, (WaveSignal)s, &tol[s], diff)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // WAVETRACE
@@ -0,0 +1,91 @@
+// wavetrace.h
+#ifndef WAVETRACE_H
+#define WAVETRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Pin waveform trace.
+// With WAVETRACE defined, the LED, motor and buzzer drivers report every
+// output change through WAVE_SET/WAVE_SET_BIT. While a capture is running
+// each change is stored with its timebase stamp, and the capture can be
+// written out as a VCD file (GTKWave etc.) or compared against a reference
+// capture with per-signal timing tolerances, e.g. to catch a red flash that
+// became 10% slower or a longer note. Without WAVETRACE the macros are empty.
+
+typedef enum {
+    WAVE_LEDS,        // 16 bits: green LEDs 0-7, red LEDs 8-15, 1 = lit
+    WAVE_MOTOR,       // 4 bits: left in, left out, right in, right out pins
+    WAVE_BUZZER_HZ,   // Buzzer frequency, 0 = silent
+    WAVE_SIGNALS
+} WaveSignal;
+
+#ifdef WAVETRACE
+
+// --- Configuration ---
+#define WAVETRACE_EVENTS 256   // 8 bytes each
+#define WAVETRACE_DUMP_CHUNK 64  // VCD text bytes per telemetry packet
+
+typedef struct {
+    uint32_t t_us;             // Since the start of the capture
+    uint16_t value;
+    uint8_t  signal;           // WaveSignal
+    uint8_t  reserved;
+} WaveEvent;
+
+typedef struct {
+    uint16_t  count;
+    uint16_t  dropped;         // Changes after the buffer filled up
+    uint16_t  initial[WAVE_SIGNALS];
+    WaveEvent events[WAVETRACE_EVENTS];
+} WaveTrace;
+
+// Allowed difference for the time between two changes of one signal:
+// max(tol_us, reference interval * tol_permille / 1000). The time to a
+// signal's first change is not compared; it only depends on when the capture
+// was started.
+typedef struct {
+    uint32_t tol_us;
+    uint16_t tol_permille;
+} WaveTolerance;
+
+typedef struct {
+    WaveSignal signal;         // First signal that differs
+    uint16_t   change;         // Index of the change on that signal
+    uint32_t   ref_us;         // Interval (or value, if values differ) in the reference
+    uint32_t   run_us;         // ... and in the run
+    bool       value_differs;  // Different value or change count, not timing
+} WaveDiff;
+
+extern WaveTrace wavetrace;
+
+// --- Function Prototypes ---
+void   wavetrace_set(WaveSignal signal, uint16_t value);
+void   wavetrace_set_bit(WaveSignal signal, uint32_t bit, bool on);
+void   wavetrace_start(void);  // Clears the capture and starts recording
+void   wavetrace_stop(void);
+
+// Writes trace as VCD through emit(), one line at a time.
+void   wavetrace_write_vcd(const WaveTrace *trace, void (*emit)(const char *line, size_t len));
+// The live capture as VCD on UART2 (thread context), in telemetry packets of
+// TELEMETRY_TYPE_WAVETRACE: [type][offset lo][offset hi][up to
+// WAVETRACE_DUMP_CHUNK bytes of text], offset being that of the text in the
+// file (low 16 bits).
+void   wavetrace_dump_uart(void);
+// Returns true if run matches ref within tol[signal] for every signal,
+// otherwise fills diff with the first mismatch.
+bool   wavetrace_compare(const WaveTrace *ref, const WaveTrace *run,
+                         const WaveTolerance tol[WAVE_SIGNALS], WaveDiff *diff);
+
+#define WAVE_SET(signal, value)       wavetrace_set((signal), (value))
+#define WAVE_SET_BIT(signal, bit, on) wavetrace_set_bit((signal), (bit), (on))
+
+#else // !WAVETRACE
+
+#define WAVE_SET(signal, value)       ((void)0)
+#define WAVE_SET_BIT(signal, bit, on) ((void)0)
+
+#endif // WAVETRACE
+
+#endif // WAVETRACE_H